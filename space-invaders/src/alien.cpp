@@ -0,0 +1,161 @@
+#include "alien.hpp"
+#include "../vendor/raylib/src/rlgl.h"
+
+#include <algorithm>
+#include <limits>
+
+// Whole chunks of lanes, like the laser update, so the loop vectorises. The
+// arrays are padded to a multiple of lanes.
+static void MarchAliens(float* __restrict x,
+    float* __restrict y,
+    int count,
+    float dx,
+    float dy)
+{
+    for (int chunk = 0; chunk < count; chunk += AlienFormation::lanes) {
+        for (int i = chunk; i < chunk + AlienFormation::lanes; i++) {
+            x[i] += dx;
+            y[i] += dy;
+        }
+    }
+}
+
+AlienFormation::AlienFormation(const Atlas& atlas)
+    : type_start {}
+    , alive_count(0)
+    , atlas(atlas)
+    , direction(1)
+    , left(0)
+    , right(0)
+    , bounds_dirty(false)
+{
+    for (int type = 0; type < types; type++) {
+        sprites[type] = atlas.Get(Sprite(int(Sprite::Alien1) + type));
+    }
+}
+
+auto AlienFormation::Create(int rows, int cols, Vector2 top_left, Vector2 spacing) -> void
+{
+    int count = rows * cols;
+    int padded = (count + lanes - 1) / lanes * lanes;
+    x.assign(padded, 0);
+    y.assign(padded, 0);
+    alive.assign(padded, 0);
+
+    // The top fifth of the rows are type 2, the next two fifths type 1 and
+    // the rest type 0, as in the arcade game. Rows are stored bottom up so
+    // each type is one range, lowest type first.
+    int index = 0;
+    for (int type = 0; type < types; type++) {
+        type_start[type] = index;
+        for (int row = rows - 1; row >= 0; row--) {
+            int row_type = row < (rows + 4) / 5 ? 2 : row < (rows * 3 + 4) / 5 ? 1 : 0;
+            if (row_type != type) {
+                continue;
+            }
+            for (int col = 0; col < cols; col++) {
+                x[index] = top_left.x + col * spacing.x;
+                y[index] = top_left.y + row * spacing.y;
+                alive[index] = 1;
+                index++;
+            }
+        }
+    }
+    type_start[types] = index;
+    alive_count = count;
+    direction = 1;
+    bounds_dirty = true;
+}
+
+auto AlienFormation::Update() -> void
+{
+    if (alive_count == 0) {
+        return;
+    }
+    if (bounds_dirty) {
+        UpdateBounds();
+    }
+    float dx = direction * step;
+    float dy = 0;
+    if (left + dx < 0 || right + dx > GetScreenWidth()) {
+        direction = -direction;
+        dx = 0;
+        dy = drop;
+    }
+    MarchAliens(x.data(), y.data(), x.size(), dx, dy);
+    left += dx;
+    right += dx;
+}
+
+auto AlienFormation::Draw() const -> void
+{
+    const Texture2D& texture = atlas.GetTexture();
+    for (int type = 0; type < types; type++) {
+        const Rectangle& sprite = sprites[type];
+        float u0 = sprite.x / texture.width;
+        float v0 = sprite.y / texture.height;
+        float u1 = (sprite.x + sprite.width) / texture.width;
+        float v1 = (sprite.y + sprite.height) / texture.height;
+
+        // rlgl flushes and carries on by itself when the batch fills up
+        rlSetTexture(texture.id);
+        rlBegin(RL_QUADS);
+        rlColor4ub(255, 255, 255, 255);
+        rlNormal3f(0, 0, 1);
+        for (int i = type_start[type]; i < type_start[type + 1]; i++) {
+            if (!alive[i]) {
+                continue;
+            }
+            float left = x[i];
+            float top = y[i];
+            float right = left + sprite.width;
+            float bottom = top + sprite.height;
+            rlTexCoord2f(u0, v0);
+            rlVertex2f(left, top);
+            rlTexCoord2f(u0, v1);
+            rlVertex2f(left, bottom);
+            rlTexCoord2f(u1, v1);
+            rlVertex2f(right, bottom);
+            rlTexCoord2f(u1, v0);
+            rlVertex2f(right, top);
+        }
+        rlEnd();
+    }
+    rlSetTexture(0);
+}
+
+auto AlienFormation::Count() const -> int { return type_start[types]; }
+
+auto AlienFormation::AliveCount() const -> int { return alive_count; }
+
+auto AlienFormation::GetRect(int index) const -> Rectangle
+{
+    int type = std::upper_bound(type_start.begin() + 1, type_start.end(), index) - type_start.begin() - 1;
+    return { x[index], y[index], sprites[type].width, sprites[type].height };
+}
+
+auto AlienFormation::IsAlive(int index) const -> bool { return alive[index]; }
+
+auto AlienFormation::Kill(int index) -> void
+{
+    if (alive[index]) {
+        alive[index] = 0;
+        alive_count--;
+        bounds_dirty = true;
+    }
+}
+
+void AlienFormation::UpdateBounds()
+{
+    left = std::numeric_limits<float>::max();
+    right = std::numeric_limits<float>::lowest();
+    for (int type = 0; type < types; type++) {
+        for (int i = type_start[type]; i < type_start[type + 1]; i++) {
+            if (alive[i]) {
+                left = std::min(left, x[i]);
+                right = std::max(right, x[i] + sprites[type].width);
+            }
+        }
+    }
+    bounds_dirty = false;
+}
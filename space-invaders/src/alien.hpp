@@ -0,0 +1,58 @@
+#pragma once
+
+#include "../include/raylib-cpp.hpp"
+#include "atlas.hpp"
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+// The alien formation, stored as parallel arrays so a march step is one
+// vectorised pass over x and y. Aliens are laid out grouped by type, and
+// Draw() sends each type to rlgl as one run of textured quads from the shared
+// atlas, with no per sprite draw call, so the formation can grow to tens of
+// thousands.
+class AlienFormation {
+public:
+    static constexpr int types = 3;
+    static constexpr int lanes = 16;
+    // Pixels moved sideways per frame, and down when the formation turns
+    static constexpr float step = 1;
+    static constexpr float drop = 4;
+
+    AlienFormation(const Atlas& atlas);
+
+    // Replaces the formation with rows by cols aliens, spacing apart, the
+    // top row the highest type down to the lowest at the bottom
+    void Create(int rows, int cols, Vector2 top_left, Vector2 spacing);
+    // Marches one step, dropping and turning around at the screen edges
+    void Update();
+    void Draw() const;
+
+    int Count() const;
+    int AliveCount() const;
+    Rectangle GetRect(int index) const;
+    bool IsAlive(int index) const;
+    void Kill(int index);
+
+private:
+    void UpdateBounds();
+
+    std::vector<float> x;
+    std::vector<float> y;
+    std::vector<uint8_t> alive;
+    // Aliens of type t are [type_start[t], type_start[t + 1])
+    std::array<int, types + 1> type_start;
+    int alive_count;
+
+    const Atlas& atlas;
+    // Sprite of each type, alien_1 to alien_3
+    std::array<Rectangle, types> sprites;
+
+    float direction;
+    // Left and right edges of the living aliens, moved along with them and
+    // only rescanned after a kill
+    float left;
+    float right;
+    bool bounds_dirty;
+};
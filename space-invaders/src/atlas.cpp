@@ -0,0 +1,73 @@
+#include "atlas.hpp"
+
+#define STB_RECT_PACK_IMPLEMENTATION
+// Static, raylib builds its own copy of stb_rect_pack into the library
+#define STBRP_STATIC
+#include "../vendor/raylib/src/external/stb_rect_pack.h"
+
+#include <algorithm>
+#include <vector>
+
+Atlas::Atlas()
+{
+    std::array<Image, sprite_count> images;
+    std::vector<stbrp_rect> packed;
+    for (int i = 0; i < sprite_count; i++) {
+        images[i] = LoadImage(files[i]);
+        packed.push_back({ i, images[i].width + 2 * padding, images[i].height + 2 * padding, 0, 0, 0 });
+    }
+    // One extra rect at the end for the white pixel shapes are drawn with
+    packed.push_back({ sprite_count, 1 + 2 * padding, 1 + 2 * padding, 0, 0, 0 });
+
+    // stb_rect_pack wants a node per column of the target
+    std::vector<stbrp_node> nodes(width);
+    stbrp_context context;
+    stbrp_init_target(&context, width, max_height, nodes.data(), nodes.size());
+    if (!stbrp_pack_rects(&context, packed.data(), packed.size())) {
+        TraceLog(LOG_ERROR, "ATLAS: Sprites don't fit in %dx%d pixels", width, max_height);
+    }
+
+    // Only as tall as the packed sprites reach
+    int height = 1;
+    for (const auto& rect : packed) {
+        if (rect.was_packed) {
+            height = std::max(height, rect.y + rect.h);
+        }
+    }
+
+    Image image = GenImageColor(width, height, BLANK);
+    Rectangle white {};
+    for (const auto& rect : packed) {
+        if (!rect.was_packed) {
+            continue;
+        }
+        Rectangle area = { float(rect.x + padding), float(rect.y + padding), float(rect.w - 2 * padding), float(rect.h - 2 * padding) };
+        if (rect.id == sprite_count) {
+            ImageDrawPixel(&image, area.x, area.y, WHITE);
+            white = area;
+            continue;
+        }
+        const Image& sprite = images[rect.id];
+        ImageDraw(&image, sprite, { 0, 0, float(sprite.width), float(sprite.height) }, area, WHITE);
+        rects[rect.id] = area;
+    }
+    for (auto& sprite : images) {
+        UnloadImage(sprite);
+    }
+    texture = LoadTextureFromImage(image);
+    UnloadImage(image);
+
+    // The atlas lives as long as the game, nothing draws shapes after it goes
+    SetShapesTexture(texture, white);
+}
+
+Atlas::~Atlas() { UnloadTexture(texture); }
+
+auto Atlas::Get(Sprite sprite) const -> Rectangle { return rects[int(sprite)]; }
+
+auto Atlas::Draw(Sprite sprite, Vector2 position) const -> void
+{
+    DrawTextureRec(texture, rects[int(sprite)], position, WHITE);
+}
+
+auto Atlas::GetTexture() const -> const Texture2D& { return texture; }
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "../include/raylib-cpp.hpp"
+
+#include <array>
+
+enum class Sprite {
+    Alien1,
+    Alien2,
+    Alien3,
+    Mystery,
+    Spaceship,
+    Count,
+};
+
+// Every sprite in gfx packed into one texture at startup by stb_rect_pack, so
+// drawing sprites never switches textures and raylib keeps them all in one
+// batch. The shapes texture points at a white pixel of the atlas too, so
+// lasers drawn as rectangles join the same batch.
+class Atlas {
+public:
+    static constexpr int sprite_count = int(Sprite::Count);
+    static constexpr int width = 256;
+    // Height the packer may use, the texture is cut down to what it needs
+    static constexpr int max_height = 1024;
+    // Empty pixels around each sprite, so neighbours never bleed in
+    static constexpr int padding = 1;
+    static constexpr std::array<const char*, sprite_count> files = {
+        "gfx/alien_1.png",
+        "gfx/alien_2.png",
+        "gfx/alien_3.png",
+        "gfx/mystery.png",
+        "gfx/spaceship.png",
+    };
+
+    Atlas();
+    ~Atlas();
+    Atlas(const Atlas&) = delete;
+    Atlas& operator=(const Atlas&) = delete;
+
+    Rectangle Get(Sprite sprite) const;
+    void Draw(Sprite sprite, Vector2 position) const;
+    const Texture2D& GetTexture() const;
+
+private:
+    Texture2D texture;
+    std::array<Rectangle, sprite_count> rects;
+};
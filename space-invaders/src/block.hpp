@@ -1,13 +0,0 @@
-#pragma once
-
-#include "../include/raylib-cpp.hpp"
-
-class Block {
-public:
-    Block(Vector2 position);
-    void Draw();
-    Block();
-
-private:
-    Vector2 position;
-};
\ No newline at end of file
@@ -0,0 +1,95 @@
+#include "collision.hpp"
+
+#include <cmath>
+
+Broadphase::Broadphase(float width, float height, float cell_size)
+    : cell_size(cell_size)
+    , cols(std::max(1, int(std::ceil(width / cell_size))))
+    , rows(std::max(1, int(std::ceil(height / cell_size))))
+    , cell_start(cols * rows + 1)
+    , cell_solids(cols * rows)
+    , stats {}
+{
+}
+
+void Broadphase::Clear()
+{
+    colliders.clear();
+    cell_entries.clear();
+    stats = {};
+}
+
+void Broadphase::Add(Rectangle rect, ColliderKind kind, int index)
+{
+    colliders.push_back({ rect, kind, index });
+}
+
+void Broadphase::Build()
+{
+    std::fill(cell_start.begin(), cell_start.end(), 0);
+    std::fill(cell_solids.begin(), cell_solids.end(), 0);
+
+    // Count the entries of each cell, shifted one along so the prefix sum
+    // below turns the counts into start offsets
+    ranges.resize(colliders.size());
+    for (int i = 0; i < int(colliders.size()); i++) {
+        const Collider& collider = colliders[i];
+        CellRange range = ranges[i] = Cells(collider.rect);
+        for (int row = range.first_row; row <= range.last_row; row++) {
+            for (int col = range.first_col; col <= range.last_col; col++) {
+                cell_start[row * cols + col + 1]++;
+                if (collider.kind != ColliderKind::Laser) {
+                    cell_solids[row * cols + col]++;
+                }
+            }
+        }
+    }
+    for (int cell = 0; cell < cols * rows; cell++) {
+        cell_start[cell + 1] += cell_start[cell];
+    }
+
+    // Fill in two passes, everything but lasers first so they come first in
+    // every cell
+    cell_entries.resize(cell_start.back());
+    cell_fill.assign(cell_start.begin(), cell_start.end() - 1);
+    for (int pass = 0; pass < 2; pass++) {
+        for (int i = 0; i < int(colliders.size()); i++) {
+            bool laser = colliders[i].kind == ColliderKind::Laser;
+            if (laser != (pass == 1)) {
+                continue;
+            }
+            const CellRange& range = ranges[i];
+            for (int row = range.first_row; row <= range.last_row; row++) {
+                for (int col = range.first_col; col <= range.last_col; col++) {
+                    cell_entries[cell_fill[row * cols + col]++] = i;
+                }
+            }
+        }
+    }
+
+    stats.colliders = colliders.size();
+    stats.cell_entries = cell_entries.size();
+}
+
+const CollisionStats& Broadphase::GetStats() const { return stats; }
+
+Broadphase::CellRange Broadphase::Cells(const Rectangle& rect) const
+{
+    // Clamped, anything off the edge of the world lands in the border cells.
+    // Clamping first makes truncating the same as rounding down.
+    auto clamp = [](float value, int count) {
+        return int(std::clamp(value, 0.0f, float(count - 1)));
+    };
+    return {
+        clamp(rect.x / cell_size, cols),
+        clamp((rect.x + rect.width) / cell_size, cols),
+        clamp(rect.y / cell_size, rows),
+        clamp((rect.y + rect.height) / cell_size, rows),
+    };
+}
+
+int Broadphase::CellOf(float x, float y) const
+{
+    CellRange range = Cells({ x, y, 0, 0 });
+    return range.first_row * cols + range.first_col;
+}
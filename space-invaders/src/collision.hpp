@@ -0,0 +1,113 @@
+#pragma once
+
+#include "../include/raylib-cpp.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+enum class ColliderKind : uint8_t {
+    Laser,
+    Obstacle,
+    Ship,
+    Alien,
+};
+
+struct Collider {
+    Rectangle rect;
+    ColliderKind kind;
+    // Index of the object in whatever owns it, e.g. the laser pool slot
+    int index;
+};
+
+struct CollisionStats {
+    int colliders;
+    // Collider entries over all cells, a collider is in every cell it touches
+    int cell_entries;
+    // Pairs that shared a cell and were tested with CheckCollisionRecs
+    int candidate_pairs;
+    // Pairs that really overlap, each reported once
+    int overlapping_pairs;
+};
+
+// Uniform grid broadphase, rebuilt from scratch every frame. Build() bins the
+// colliders with a counting sort, so every cell's entries sit next to each
+// other in one array and the rebuild is linear in the number of colliders.
+// The arrays keep their capacity between frames, so after the first few
+// frames it doesn't allocate.
+//
+// Lasers are never paired with each other, which keeps dense volleys cheap:
+// within a cell every other collider comes before the lasers, and pairs are
+// only formed with at least one non-laser.
+class Broadphase {
+public:
+    Broadphase(float width, float height, float cell_size);
+
+    void Clear();
+    void Add(Rectangle rect, ColliderKind kind, int index);
+    void Build();
+
+    // Calls fn(a, b) once for every overlapping pair of different kinds. a is
+    // never a laser, b is when either is.
+    template <typename Fn>
+    void ForEachPair(Fn&& fn);
+
+    const CollisionStats& GetStats() const;
+
+private:
+    struct CellRange {
+        int first_col;
+        int last_col;
+        int first_row;
+        int last_row;
+    };
+
+    CellRange Cells(const Rectangle& rect) const;
+    int CellOf(float x, float y) const;
+
+    float cell_size;
+    int cols;
+    int rows;
+    std::vector<Collider> colliders;
+    // Cells each collider touches, worked out once per Build()
+    std::vector<CellRange> ranges;
+    // Entries of cell n are cell_entries[cell_start[n] .. cell_start[n + 1])
+    std::vector<int> cell_start;
+    std::vector<int> cell_entries;
+    // Non-laser entries at the front of each cell
+    std::vector<int> cell_solids;
+    // Where Build() puts the next entry of each cell
+    std::vector<int> cell_fill;
+    CollisionStats stats;
+};
+
+template <typename Fn>
+void Broadphase::ForEachPair(Fn&& fn)
+{
+    for (int cell = 0; cell < cols * rows; cell++) {
+        int begin = cell_start[cell];
+        int end = cell_start[cell + 1];
+        int solids_end = begin + cell_solids[cell];
+        for (int i = begin; i < solids_end; i++) {
+            const Collider& a = colliders[cell_entries[i]];
+            for (int j = i + 1; j < end; j++) {
+                const Collider& b = colliders[cell_entries[j]];
+                if (a.kind == b.kind) {
+                    continue;
+                }
+                stats.candidate_pairs++;
+                if (!CheckCollisionRecs(a.rect, b.rect)) {
+                    continue;
+                }
+                // A pair sharing several cells is only reported from the cell
+                // holding the top left corner of their overlap
+                float x = std::max(a.rect.x, b.rect.x);
+                float y = std::max(a.rect.y, b.rect.y);
+                if (CellOf(x, y) == cell) {
+                    stats.overlapping_pairs++;
+                    fn(a, b);
+                }
+            }
+        }
+    }
+}
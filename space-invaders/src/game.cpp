@@ -1,27 +1,44 @@
 #include "game.hpp"
 
-Game::Game() { obstacles = CreateObstacles(); }
+Game::Game()
+    : spaceship(atlas)
+    , aliens(atlas)
+    , broadphase(GetScreenWidth(), GetScreenHeight(), collision_cell_size)
+    , stress_mode(false)
+{
+    obstacles = CreateObstacles();
+    aliens.Create(5, 11, { 75, 110 }, { 55, 55 });
+}
 
 Game::~Game() { }
 
 auto Game::Draw() -> void
 {
-    spaceship.Draw();
-
-    for (auto& laser : spaceship.lasers) {
-        laser.Draw();
-    }
+    // Bunkers have their own textures, everything after them comes from the
+    // atlas and goes out in one batch
     for (auto& obs : obstacles) {
         obs.Draw();
     }
+    spaceship.Draw();
+    spaceship.lasers.Draw();
+    aliens.Draw();
+    if (stress_mode) {
+        DrawFPS(10, 10);
+        DrawText(TextFormat("lasers: %d", spaceship.lasers.Count()), 10, 35, 20, RAYWHITE);
+        const CollisionStats& stats = broadphase.GetStats();
+        DrawText(TextFormat("cell entries: %d", stats.cell_entries), 10, 60, 20, RAYWHITE);
+        DrawText(TextFormat("pairs tested: %d hit: %d", stats.candidate_pairs, stats.overlapping_pairs), 10, 85, 20, RAYWHITE);
+    }
 }
 
 auto Game::Update() -> void
 {
-
-    for (auto& laser : spaceship.lasers) {
-        laser.Update();
+    if (stress_mode) {
+        FireStressLasers();
     }
+    spaceship.lasers.Update();
+    aliens.Update();
+    CheckForCollisions();
     DeleteInactiveLasers();
 }
 
@@ -36,28 +53,94 @@ auto Game::HandleInput() -> void
     if (IsKeyDown(KEY_SPACE)) {
         spaceship.FireLaser();
     }
+    if (IsKeyPressed(KEY_S)) {
+        stress_mode = !stress_mode;
+    }
 }
 
-void Game::DeleteInactiveLasers()
+void Game::CheckForCollisions()
+{
+    LaserPool& lasers = spaceship.lasers;
+
+    broadphase.Clear();
+    broadphase.Add(spaceship.GetRect(), ColliderKind::Ship, 0);
+    for (int i = 0; i < int(obstacles.size()); i++) {
+        broadphase.Add(obstacles[i].GetRect(), ColliderKind::Obstacle, i);
+    }
+    for (int i = 0; i < aliens.Count(); i++) {
+        if (aliens.IsAlive(i)) {
+            broadphase.Add(aliens.GetRect(i), ColliderKind::Alien, i);
+        }
+    }
+    for (int i = 0; i < lasers.Count(); i++) {
+        if (lasers.IsActive(i)) {
+            broadphase.Add(lasers.GetRect(i), ColliderKind::Laser, i);
+        }
+    }
+    broadphase.Build();
+
+    broadphase.ForEachPair([&](const Collider& a, const Collider& b) {
+        if (b.kind != ColliderKind::Laser) {
+            // Aliens marching down chew through the bunkers
+            if (a.kind == ColliderKind::Alien && b.kind == ColliderKind::Obstacle) {
+                obstacles[b.index].Erode(a.rect);
+            } else if (a.kind == ColliderKind::Obstacle && b.kind == ColliderKind::Alien) {
+                obstacles[a.index].Erode(b.rect);
+            }
+            return;
+        }
+        if (!lasers.IsActive(b.index)) {
+            return;
+        }
+        switch (a.kind) {
+        case ColliderKind::Obstacle:
+            // The bunker's rect is only its bounds, the laser goes on through
+            // the gaps until it hits a solid cell
+            if (obstacles[a.index].Erode(b.rect) > 0) {
+                lasers.Deactivate(b.index);
+            }
+            break;
+        case ColliderKind::Ship:
+            // The player's own lasers start on top of the ship
+            if (lasers.GetSpeed(b.index) > 0) {
+                lasers.Deactivate(b.index);
+            }
+            break;
+        case ColliderKind::Alien:
+            if (lasers.GetSpeed(b.index) < 0 && aliens.IsAlive(a.index)) {
+                aliens.Kill(a.index);
+                lasers.Deactivate(b.index);
+            }
+            break;
+        case ColliderKind::Laser:
+            break;
+        }
+    });
+}
+
+void Game::DeleteInactiveLasers() { spaceship.lasers.Compact(); }
+
+void Game::FireStressLasers()
 {
-    for (auto it = spaceship.lasers.begin(); it != spaceship.lasers.end();) {
-        if (!it->active) {
-            it = spaceship.lasers.erase(it);
-        } else {
-            ++it;
+    float bottom = GetScreenHeight() - LaserPool::height;
+    for (int i = 0; i < stress_shots_per_frame; i++) {
+        float x = GetRandomValue(0, GetScreenWidth() - LaserPool::width);
+        if (!spaceship.lasers.Spawn({ x, bottom }, -GetRandomValue(3, 9))) {
+            break;
         }
     }
 }
 
 std::vector<Obstacle> Game::CreateObstacles()
 {
-    int obstacle_width = Obstacle::grid[0].size() * 3;
+    int obstacle_width = Obstacle::width;
     float gap = (GetScreenWidth() - (4 * obstacle_width)) / 5;
 
+    std::vector<Obstacle> created;
     for (int i = 0; i < 4; i++) {
         float offset_x = (i + 1) * gap + i * obstacle_width;
-        obstacles.push_back(Obstacle({ offset_x, float(GetScreenHeight() - 100) }));
+        created.emplace_back(Vector2 { offset_x, float(GetScreenHeight() - 100) });
     }
 
-    return obstacles;
+    return created;
 }
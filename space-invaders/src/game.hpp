@@ -1,5 +1,8 @@
 #pragma once
 
+#include "alien.hpp"
+#include "atlas.hpp"
+#include "collision.hpp"
 #include "obstacle.hpp"
 #include "spaceship.hpp"
 
@@ -14,9 +17,22 @@ public:
     void Update();
     void HandleInput();
 
+    // Fires this many lasers from random spots every frame while stress mode
+    // is on (S), to load test the laser pool
+    static constexpr int stress_shots_per_frame = 2000;
+    // Side of a broadphase grid cell, a couple of lasers high
+    static constexpr float collision_cell_size = 32;
+
 private:
+    void CheckForCollisions();
     void DeleteInactiveLasers();
+    void FireStressLasers();
     std::vector<Obstacle> CreateObstacles();
+    // Declared first, the sprites below draw from it
+    Atlas atlas;
     Spaceship spaceship;
     std::vector<Obstacle> obstacles;
+    AlienFormation aliens;
+    Broadphase broadphase;
+    bool stress_mode;
 };
\ No newline at end of file
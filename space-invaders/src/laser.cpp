@@ -1,30 +1,86 @@
 #include "laser.hpp"
 
-Laser::Laser(Vector2 position, int speed)
-    : position(position)
-    , speed(speed)
-    , active(true)
+// Runs in whole chunks of lanes so the inner loop has a fixed trip count,
+// which the compiler vectorises. Slots past the live lasers in the last
+// chunk hold stale data, moving them is harmless.
+static void MoveLasers(float* __restrict y,
+    const float* __restrict speed,
+    uint8_t* __restrict active,
+    int count,
+    float bottom)
+{
+    for (int chunk = 0; chunk < count; chunk += LaserPool::lanes) {
+        for (int i = chunk; i < chunk + LaserPool::lanes; i++) {
+            y[i] += speed[i];
+            active[i] &= (y[i] >= 0) & (y[i] <= bottom);
+        }
+    }
+}
+
+LaserPool::LaserPool()
+    : x(capacity)
+    , y(capacity)
+    , speed(capacity)
+    , active(capacity)
+    , count(0)
 {
 }
 
-Laser::~Laser()
+auto LaserPool::Spawn(Vector2 position, float laser_speed) -> bool
 {
-    // std::cout << "Laser destroyed\n";
+    if (count == capacity) {
+        return false;
+    }
+    x[count] = position.x;
+    y[count] = position.y;
+    speed[count] = laser_speed;
+    active[count] = 1;
+    count++;
+    return true;
 }
 
-auto Laser::Draw() -> void
+auto LaserPool::Update() -> void
 {
-    if (active) {
-        DrawRectangle(position.x, position.y, 4, 15, { 243, 216, 63, 255 });
+    int n = (count + lanes - 1) / lanes * lanes;
+    MoveLasers(y.data(), speed.data(), active.data(), n, GetScreenHeight());
+}
+
+auto LaserPool::Compact() -> void
+{
+    int i = 0;
+    while (i < count) {
+        if (active[i]) {
+            i++;
+            continue;
+        }
+        count--;
+        x[i] = x[count];
+        y[i] = y[count];
+        speed[i] = speed[count];
+        active[i] = active[count];
     }
 }
 
-auto Laser::Update() -> void
+auto LaserPool::Draw() const -> void
 {
-    if (active) {
-        position.y += speed;
-        if (position.y > GetScreenHeight() || position.y < 0) {
-            active = false;
+    for (int i = 0; i < count; i++) {
+        if (active[i]) {
+            DrawRectangle(x[i], y[i], width, height, { 243, 216, 63, 255 });
         }
     }
-}
\ No newline at end of file
+}
+
+auto LaserPool::Clear() -> void { count = 0; }
+
+auto LaserPool::Count() const -> int { return count; }
+
+auto LaserPool::GetRect(int index) const -> Rectangle
+{
+    return { x[index], y[index], width, height };
+}
+
+auto LaserPool::IsActive(int index) const -> bool { return active[index]; }
+
+auto LaserPool::GetSpeed(int index) const -> float { return speed[index]; }
+
+auto LaserPool::Deactivate(int index) -> void { active[index] = 0; }
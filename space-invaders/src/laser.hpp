@@ -2,15 +2,42 @@
 
 #include "../include/raylib-cpp.hpp"
 
-class Laser {
+#include <cstdint>
+#include <vector>
+
+// Every laser in flight, stored as parallel arrays sized once up front so
+// firing never allocates. The first Count() slots are the live lasers;
+// Compact() swaps dead ones out with the last live one.
+class LaserPool {
 public:
-    Laser(Vector2 position, int speed);
-    ~Laser();
-    void Draw();
+    static constexpr int capacity = 1 << 18;
+    static constexpr int width = 4;
+    static constexpr int height = 15;
+    // Lasers updated per step of the batch update
+    static constexpr int lanes = 16;
+
+    LaserPool();
+
+    // False when the pool is full
+    bool Spawn(Vector2 position, float speed);
+    // Moves every laser and retires the ones that left the screen
     void Update();
-    bool active;
+    // Drops retired lasers, O(1) per laser
+    void Compact();
+    void Draw() const;
+    void Clear();
+
+    int Count() const;
+    Rectangle GetRect(int index) const;
+    bool IsActive(int index) const;
+    // Negative for lasers going up, fired by the player
+    float GetSpeed(int index) const;
+    void Deactivate(int index);
 
 private:
-    Vector2 position;
-    int speed;
-};
\ No newline at end of file
+    std::vector<float> x;
+    std::vector<float> y;
+    std::vector<float> speed;
+    std::vector<uint8_t> active;
+    int count;
+};
@@ -1,6 +1,11 @@
 #include "obstacle.hpp"
 
-std::vector<std::vector<int>> Obstacle::grid = {
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <utility>
+
+const std::array<std::array<int, Obstacle::cols>, Obstacle::rows> Obstacle::grid = { {
     { 0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0 },
     { 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0 },
     { 0, 0, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0 },
@@ -13,28 +18,96 @@ std::vector<std::vector<int>> Obstacle::grid = {
     { 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1 },
     { 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 1 },
     { 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1 },
-    { 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1 }
-};
+    { 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1 },
+} };
 
 Obstacle::Obstacle(Vector2 position)
     : position(position)
+    , dirty(true)
 {
-
-    for (unsigned int row = 0; row < grid.size(); row++) {
-        for (unsigned int col = 0; col < grid[row].size(); col++) {
+    for (int row = 0; row < rows; row++) {
+        mask[row] = 0;
+        for (int col = 0; col < cols; col++) {
             if (grid[row][col] == 1) {
-                float pos_x = position.x + col * 3;
-                float pos_y = position.y + row * 3;
-                auto block = Block({ pos_x, pos_y });
-                blocks.push_back(block);
+                mask[row] |= 1u << col;
             }
         }
     }
+    Image image = GenImageColor(cols, rows, BLANK);
+    texture = LoadTextureFromImage(image);
+    UnloadImage(image);
+}
+
+Obstacle::~Obstacle() { UnloadTexture(texture); }
+
+Obstacle::Obstacle(Obstacle&& other) noexcept
+    : position(other.position)
+    , mask(other.mask)
+    , texture(other.texture)
+    , dirty(other.dirty)
+{
+    other.texture.id = 0;
+}
+
+Obstacle& Obstacle::operator=(Obstacle&& other) noexcept
+{
+    std::swap(position, other.position);
+    std::swap(mask, other.mask);
+    std::swap(texture, other.texture);
+    std::swap(dirty, other.dirty);
+    return *this;
 }
 
 auto Obstacle::Draw() -> void
 {
-    for (auto& block : blocks) {
-        block.Draw();
+    if (dirty) {
+        UploadTexture();
     }
-}
\ No newline at end of file
+    DrawTextureEx(texture, position, 0, cell_size, WHITE);
+}
+
+auto Obstacle::GetRect() const -> Rectangle
+{
+    return { position.x, position.y, width, height };
+}
+
+auto Obstacle::IsSolid(int row, int col) const -> bool
+{
+    return (mask[row] >> col) & 1;
+}
+
+auto Obstacle::Erode(Rectangle area) -> int
+{
+    // Cells the area overlaps, clamped to the grid
+    float left = (area.x - position.x) / cell_size;
+    float top = (area.y - position.y) / cell_size;
+    int first_col = std::max(0, int(std::floor(left)));
+    int last_col = std::min(cols - 1, int(std::ceil(left + area.width / cell_size)) - 1);
+    int first_row = std::max(0, int(std::floor(top)));
+    int last_row = std::min(rows - 1, int(std::ceil(top + area.height / cell_size)) - 1);
+    if (first_col > last_col || first_row > last_row) {
+        return 0;
+    }
+
+    uint32_t columns = ((2u << last_col) - 1) & ~((1u << first_col) - 1);
+    int cleared = 0;
+    for (int row = first_row; row <= last_row; row++) {
+        cleared += std::popcount(mask[row] & columns);
+        mask[row] &= ~columns;
+    }
+    dirty = dirty || cleared > 0;
+    return cleared;
+}
+
+void Obstacle::UploadTexture()
+{
+    std::array<Color, rows * cols> pixels;
+    for (int row = 0; row < rows; row++) {
+        for (int col = 0; col < cols; col++) {
+            bool solid = IsSolid(row, col);
+            pixels[row * cols + col] = solid ? Color { 243, 216, 63, 255 } : BLANK;
+        }
+    }
+    UpdateTexture(texture, pixels.data());
+    dirty = false;
+}
@@ -1,16 +1,45 @@
 #pragma once
 
-#include "block.hpp"
-#include <vector>
+#include "../include/raylib-cpp.hpp"
 
-class Obstacle {
+#include <array>
+#include <cstdint>
 
+// A destructible bunker. Each row of cells is one packed bit mask, bit n set
+// while column n is still standing, so a hit is a bit test and a clear. The
+// cells are drawn from a texture the size of the grid, scaled up, which is
+// only uploaded again after a hit changed the mask.
+class Obstacle {
 public:
+    static constexpr int rows = 13;
+    static constexpr int cols = 23;
+    static constexpr int cell_size = 3;
+    static constexpr int width = cols * cell_size;
+    static constexpr int height = rows * cell_size;
+
     Obstacle(Vector2 position);
+    ~Obstacle();
+    Obstacle(const Obstacle&) = delete;
+    Obstacle& operator=(const Obstacle&) = delete;
+    Obstacle(Obstacle&& other) noexcept;
+    Obstacle& operator=(Obstacle&& other) noexcept;
+
     void Draw();
+    // Screen space bounds of the whole bunker
+    Rectangle GetRect() const;
+    bool IsSolid(int row, int col) const;
+    // Clears every standing cell the area overlaps and returns how many
+    // there were, one mask update per row touched
+    int Erode(Rectangle area);
+
     Vector2 position;
-    std::vector<Block> blocks;
-    static std::vector<std::vector<int>> grid;
 
 private:
-};
\ No newline at end of file
+    static const std::array<std::array<int, cols>, rows> grid;
+
+    void UploadTexture();
+
+    std::array<uint32_t, rows> mask;
+    Texture2D texture;
+    bool dirty;
+};
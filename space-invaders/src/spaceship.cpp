@@ -1,16 +1,15 @@
 #include "spaceship.hpp"
 
-Spaceship::Spaceship()
+Spaceship::Spaceship(const Atlas& atlas)
+    : atlas(atlas)
 {
-    image = LoadTexture("gfx/spaceship.png");
-    position.x = (GetScreenWidth() - image.width) / 2;
-    position.y = GetScreenHeight() - image.height;
+    sprite = atlas.Get(Sprite::Spaceship);
+    position.x = (GetScreenWidth() - sprite.width) / 2;
+    position.y = GetScreenHeight() - sprite.height;
     last_fired_time = 0.0;
 }
 
-Spaceship::~Spaceship() { UnloadTexture(image); }
-
-auto Spaceship::Draw() -> void { DrawTextureV(image, position, WHITE); }
+auto Spaceship::Draw() -> void { atlas.Draw(Sprite::Spaceship, position); }
 
 auto Spaceship::MoveLeft() -> void
 {
@@ -22,16 +21,20 @@ auto Spaceship::MoveLeft() -> void
 auto Spaceship::MoveRight() -> void
 {
     position.x += 5;
-    if (position.x > GetScreenWidth() - image.width) {
-        position.x = GetScreenWidth() - image.width;
+    if (position.x > GetScreenWidth() - sprite.width) {
+        position.x = GetScreenWidth() - sprite.width;
     }
 }
 
 void Spaceship::FireLaser()
 {
     if (GetTime() - last_fired_time >= 0.35) {
-        lasers.push_back(
-            Laser({ position.x + (image.width / 2) - 2, position.y }, -6));
+        lasers.Spawn({ position.x + (sprite.width / 2) - 2, position.y }, -6);
         last_fired_time = GetTime();
     }
 }
+
+auto Spaceship::GetRect() const -> Rectangle
+{
+    return { position.x, position.y, sprite.width, sprite.height };
+}
@@ -1,23 +1,23 @@
 #pragma once
 
 #include "../include/raylib-cpp.hpp"
+#include "atlas.hpp"
 #include "laser.hpp"
 
-#include <vector>
-
 class Spaceship {
 
 public:
-    Spaceship();
-    ~Spaceship();
+    Spaceship(const Atlas& atlas);
     void Draw();
     void MoveLeft();
     void MoveRight();
     void FireLaser();
-    std::vector<Laser> lasers;
+    Rectangle GetRect() const;
+    LaserPool lasers;
 
 private:
-    Texture2D image;
+    const Atlas& atlas;
+    Rectangle sprite;
     Vector2 position;
     double last_fired_time;
-};
\ No newline at end of file
+};
@@ -0,0 +1,260 @@
+// Engine microbenchmarks. Times the hot engine operations on seeded random
+// boards, and BatchEnv stepping on one thread and on the pool, and counts
+// heap allocations through a replaced global operator new.
+//
+// Usage: bench [perft depth] [seed]
+
+#include "../src/ai.hpp"
+#include "../src/batch.hpp"
+#include "../src/engine.hpp"
+#include "../src/grid.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+
+static std::atomic<long> allocations(0);
+
+auto operator new(std::size_t size) -> void*
+{
+  allocations.fetch_add(1, std::memory_order_relaxed);
+  if (void* ptr = std::malloc(size == 0 ? 1 : size))
+  {
+    return ptr;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+
+void operator delete(void* ptr, std::size_t) noexcept { std::free(ptr); }
+
+static std::mt19937 rng;
+
+static auto benchRandom(int min, int max) -> int
+{
+  return std::uniform_int_distribution<int>(min, max)(rng);
+}
+
+// Fills the bottom rows with random garbage, some of them full
+static void randomBoard(Grid& grid, int height)
+{
+  grid.initialize();
+  std::uniform_int_distribution<int> colour(1, 7);
+  std::bernoulli_distribution        filled(0.6);
+  std::bernoulli_distribution        full_row(0.2);
+  for (int row = Grid::num_rows - height; row < Grid::num_rows; row++)
+  {
+    bool full = full_row(rng);
+    for (int col = 0; col < Grid::num_cols; col++)
+    {
+      if (full || filled(rng))
+      {
+        grid.setCell(row, col, colour(rng));
+      }
+    }
+  }
+}
+
+static auto randomEngine() -> tetris::Engine
+{
+  tetris::Engine engine(rng());
+  randomBoard(engine.grid, 8);
+  return engine;
+}
+
+static volatile long sink;
+
+template <typename Fn>
+static void measure(const char* name, long ops, Fn&& fn)
+{
+  long start_allocations = allocations.load();
+  auto start             = std::chrono::steady_clock::now();
+  fn();
+  auto end    = std::chrono::steady_clock::now();
+  long allocs = allocations.load() - start_allocations;
+
+  std::chrono::duration<double, std::nano> elapsed = end - start;
+  std::printf("%-24s %12.2f ns/op %10.4f allocs/op\n",
+              name,
+              elapsed.count() / ops,
+              static_cast<double>(allocs) / ops);
+}
+
+static auto perft(const Grid&                         grid,
+                  const std::vector<int>&             pieces,
+                  std::vector<tetris::MoveGenerator>& generators,
+                  int                                 depth) -> long
+{
+  auto& generator      = generators[depth];
+  int   num_placements = generator.generate(grid, Block(pieces[depth]));
+  if (depth + 1 == static_cast<int>(pieces.size()))
+  {
+    return num_placements;
+  }
+  long nodes = 0;
+  for (int i = 0; i < num_placements; i++)
+  {
+    Grid after = grid;
+    tetris::placeBlock(after, generator.getBlock(i));
+    nodes += perft(after, pieces, generators, depth + 1);
+  }
+  return nodes;
+}
+
+auto main(int argc, char** argv) -> int
+{
+  int  depth = argc > 1 ? std::atoi(argv[1]) : 3;
+  auto seed  = argc > 2 ? std::stoul(argv[2]) : 1u;
+  rng.seed(seed);
+
+  const long iterations = 1000000;
+
+  std::printf("seed %lu, perft depth %d\n\n", seed, depth);
+
+  {
+    auto engine = randomEngine();
+    measure("moveBlockLeft/Right", 2 * iterations, [&]() {
+      for (long i = 0; i < iterations; i++)
+      {
+        engine.moveBlockLeft();
+        engine.moveBlockRight();
+      }
+    });
+  }
+  {
+    auto engine = randomEngine();
+    measure("rotateBlock", iterations, [&]() {
+      for (long i = 0; i < iterations; i++)
+      {
+        engine.rotateBlock();
+      }
+    });
+  }
+  {
+    auto engine = randomEngine();
+    measure("blockFits", iterations, [&]() {
+      long fits = 0;
+      for (long i = 0; i < iterations; i++)
+      {
+        fits += engine.blockFits();
+      }
+      sink = fits;
+    });
+  }
+  {
+    auto engine = randomEngine();
+    measure("moveBlockDown", iterations, [&]() {
+      for (long i = 0; i < iterations; i++)
+      {
+        engine.moveBlockDown();
+        if (engine.game_over)
+        {
+          engine.reset();
+        }
+      }
+    });
+  }
+  {
+    auto engine = randomEngine();
+    auto state  = engine.save();
+    measure("save/restore", iterations, [&]() {
+      for (long i = 0; i < iterations; i++)
+      {
+        engine.moveBlockDown();
+        engine.restore(state);
+        state = engine.save();
+      }
+    });
+  }
+  {
+    std::vector<Grid> grids(1 << 16);
+    for (auto& grid : grids)
+    {
+      randomBoard(grid, 8);
+    }
+    measure("clearFullRoads", static_cast<long>(grids.size()), [&]() {
+      long cleared = 0;
+      for (auto& grid : grids)
+      {
+        cleared += grid.clearFullRoads();
+      }
+      sink = cleared;
+    });
+  }
+  {
+    tetris::ThreadPool pool;
+    tetris::Player     player(pool);
+    tetris::Engine     engine(rng());
+    const long         moves = 2000;
+    measure("Player::plan", moves, [&]() {
+      for (long i = 0; i < moves; i++)
+      {
+        for (auto action : player.plan(engine))
+        {
+          engine.step(action);
+        }
+        if (engine.game_over)
+        {
+          engine.reset();
+        }
+      }
+    });
+    auto stats = player.getTable().getStats();
+    std::printf("  transposition table: %llu probes, %.1f%% hits\n",
+                static_cast<unsigned long long>(stats.probes),
+                100.0 * player.getTable().hitRate());
+  }
+  {
+    // Per board step, on one thread and then split over the pool, so the
+    // two lines show how stepping scales across cores
+    const int                   boards = 4096;
+    const long                  steps  = 500;
+    tetris::BatchEnv            batch(boards, rng());
+    tetris::ThreadPool          pool;
+    std::vector<tetris::Action> actions(boards);
+    std::vector<int>            rewards(boards);
+    std::vector<std::uint8_t>   done(boards);
+    for (auto& action : actions)
+    {
+      action = static_cast<tetris::Action>(benchRandom(0, 4));
+    }
+    measure("BatchEnv::step", boards * steps, [&]() {
+      for (long i = 0; i < steps; i++)
+      {
+        batch.step(actions.data(), rewards.data(), done.data());
+      }
+    });
+    char name[32];
+    std::snprintf(name, sizeof(name), "BatchEnv::step x%d", pool.size());
+    measure(name, boards * steps, [&]() {
+      for (long i = 0; i < steps; i++)
+      {
+        batch.step(actions.data(), rewards.data(), done.data(), pool);
+      }
+    });
+  }
+  if (depth > 0)
+  {
+    std::vector<int> pieces;
+    for (int i = 0; i < depth; i++)
+    {
+      pieces.push_back(benchRandom(1, 7));
+    }
+    Grid grid;
+    randomBoard(grid, 4);
+    std::vector<tetris::MoveGenerator> generators(depth);
+
+    long nodes = perft(grid, pieces, generators, 0);
+    std::printf("\nperft(%d) = %ld placements\n", depth, nodes);
+    measure("perft", nodes, [&]() {
+      sink = perft(grid, pieces, generators, 0);
+    });
+  }
+  return 0;
+}
@@ -0,0 +1,315 @@
+#include "ai.hpp"
+#include <algorithm>
+#include <bit>
+#include <limits>
+
+namespace tetris
+{
+
+auto evaluate(const Grid& grid, int lines) -> Features
+{
+  Features features = { 0, lines, 0, 0 };
+
+  std::array<int, Grid::num_cols> heights = {};
+  unsigned                        above   = 0;
+  for (int row = 0; row < Grid::num_rows; row++)
+  {
+    unsigned mask = grid.rowMask(row);
+    // Empty cells under something filled are holes
+    features.holes += std::popcount(above & ~mask);
+    // Columns that are filled for the first time give the column height
+    for (unsigned fresh = mask & ~above; fresh != 0; fresh &= fresh - 1)
+    {
+      heights[std::countr_zero(fresh)] = Grid::num_rows - row;
+    }
+    above |= mask;
+  }
+
+  for (int col = 0; col < Grid::num_cols; col++)
+  {
+    features.aggregate_height += heights[col];
+    if (col > 0)
+    {
+      int step = heights[col] - heights[col - 1];
+      features.bumpiness += step < 0 ? -step : step;
+    }
+  }
+  return features;
+}
+
+auto score(const Features& features, const Weights& weights) -> double
+{
+  return weights.aggregate_height * features.aggregate_height
+         + weights.lines * features.lines + weights.holes * features.holes
+         + weights.bumpiness * features.bumpiness;
+}
+
+auto placeBlock(Grid& grid, const Block& block) -> int
+{
+  auto tiles = block.getCellPosition();
+  for (const auto& item : tiles)
+  {
+    grid.setCell(item.row, item.column, block.id);
+  }
+  return grid.clearFullRoads();
+}
+
+auto MoveGenerator::stateIndex(int rotation,
+                               int row_offset,
+                               int col_offset) const -> int
+{
+  return (rotation * num_row_offsets + row_offset + 3) * num_col_offsets
+         + col_offset + 3;
+}
+
+auto MoveGenerator::generate(const Grid& grid, const Block& block) -> int
+{
+  block_id       = block.id;
+  num_placements = 0;
+  parent.fill(-1);
+  fit_cache.fill(-1);
+
+  const BlockShape& shape = blockShape(block_id);
+
+  if (!fits(
+        grid, block.getRotation(), block.getRowOffset(), block.getColOffset()))
+  {
+    return 0;
+  }
+
+  root = stateIndex(
+    block.getRotation(), block.getRowOffset(), block.getColOffset());
+  parent[root] = static_cast<std::int16_t>(root);
+
+  int head = 0;
+  int tail = 0;
+  queue[tail++] = static_cast<std::int16_t>(root);
+
+  auto visit = [&](int state, int rotation, int row, int col, Action action) {
+    int next_state = stateIndex(rotation, row, col);
+    if (parent[next_state] == -1)
+    {
+      parent[next_state]        = static_cast<std::int16_t>(state);
+      parent_action[next_state] = action;
+      queue[tail++]             = static_cast<std::int16_t>(next_state);
+    }
+  };
+
+  while (head < tail)
+  {
+    int state      = queue[head++];
+    int rotation   = state / (num_row_offsets * num_col_offsets);
+    int row_offset = state / num_col_offsets % num_row_offsets - 3;
+    int col_offset = state % num_col_offsets - 3;
+
+    // Only states that fit get visited, so every move below starts inside
+    // the grid. Kicks can still push a block further out than a single
+    // step, fits() turns those down.
+    bool can_drop = fits(grid, rotation, row_offset + 1, col_offset);
+    if (!can_drop)
+    {
+      placements[num_placements] = { rotation, row_offset, col_offset };
+      placement_states[num_placements] = static_cast<std::int16_t>(state);
+      num_placements++;
+    }
+
+    // Rotating lands on the first kick that fits, same as the engine
+    int         rotated = (rotation + 1) % shape.num_rotations;
+    const auto& kicks   = (*shape.kicks)[rotation];
+    for (int i = 0; i < shape.num_kicks; i++)
+    {
+      int row = row_offset + kicks[i].row;
+      int col = col_offset + kicks[i].column;
+      if (fits(grid, rotated, row, col))
+      {
+        visit(state, rotated, row, col, Action::Rotate);
+        break;
+      }
+    }
+    if (fits(grid, rotation, row_offset, col_offset - 1))
+    {
+      visit(state, rotation, row_offset, col_offset - 1, Action::Left);
+    }
+    if (fits(grid, rotation, row_offset, col_offset + 1))
+    {
+      visit(state, rotation, row_offset, col_offset + 1, Action::Right);
+    }
+    if (can_drop)
+    {
+      visit(state, rotation, row_offset + 1, col_offset, Action::Down);
+    }
+  }
+  return num_placements;
+}
+
+auto MoveGenerator::fits(const Grid& grid,
+                         int         rotation,
+                         int         row_offset,
+                         int         col_offset) -> bool
+{
+  // Past these every cell of the bounding box is outside the grid
+  if (row_offset < -3 || row_offset >= num_row_offsets - 3 || col_offset < -3
+      || col_offset >= num_col_offsets - 3)
+  {
+    return false;
+  }
+  auto& known = fit_cache[stateIndex(rotation, row_offset, col_offset)];
+  if (known >= 0)
+  {
+    return known != 0;
+  }
+
+  known = shapeFits<Grid>(blockRows(block_id, rotation),
+                          grid.rowMasks(),
+                          row_offset,
+                          col_offset);
+  return known != 0;
+}
+
+auto MoveGenerator::getPlacement(int index) const -> const Placement&
+{
+  return placements[index];
+}
+
+auto MoveGenerator::getBlock(int index) const -> Block
+{
+  const auto& placement = placements[index];
+  return Block(block_id,
+               placement.rotation,
+               placement.row_offset,
+               placement.col_offset);
+}
+
+auto MoveGenerator::pathTo(int index) const -> std::vector<Action>
+{
+  // Walked twice so the result is sized in one allocation
+  int length = 0;
+  for (int state = placement_states[index]; state != root;
+       state     = parent[state])
+  {
+    length++;
+  }
+  std::vector<Action> path;
+  path.reserve(length + 1);
+  for (int state = placement_states[index]; state != root;
+       state     = parent[state])
+  {
+    path.push_back(parent_action[state]);
+  }
+  std::reverse(path.begin(), path.end());
+  // Any soft drops at the end land in the same spot as one hard drop
+  while (!path.empty() && path.back() == Action::Down)
+  {
+    path.pop_back();
+  }
+  path.push_back(Action::HardDrop);
+  return path;
+}
+
+Player::Player(ThreadPool& pool, Weights weights, int table_bits)
+: weights(weights)
+, pool(pool)
+, table(table_bits)
+, table_weights(weights)
+{
+}
+
+auto Player::getTable() const -> const TranspositionTable& { return table; }
+
+auto Player::plan(const Engine& engine) -> std::vector<Action>
+{
+  const Grid&  grid           = engine.grid;
+  const Block& next           = engine.getNextBlock();
+  int          num_placements = root.generate(grid, engine.getCurrentBlock());
+  if (num_placements == 0)
+  {
+    return {};
+  }
+  if (!(weights == table_weights))
+  {
+    table.clear();
+    table_weights = weights;
+  }
+
+  pool.parallelFor(num_placements, [&](int i) {
+    thread_local MoveGenerator lookahead;
+
+    const double lowest = std::numeric_limits<double>::lowest();
+
+    Grid after = grid;
+    int  lines = placeBlock(after, root.getBlock(i));
+
+    // The cached value leaves out the first placement's lines, which only
+    // add a constant since the score is linear in them
+    auto   key  = TranspositionTable::key(after.getHash(), next.id, 0);
+    double best = lowest;
+    if (!table.probe(key, best))
+    {
+      int num_next = lookahead.generate(after, next);
+      for (int j = 0; j < num_next; j++)
+      {
+        Grid final_grid  = after;
+        int  final_lines = placeBlock(final_grid, lookahead.getBlock(j));
+        best
+          = std::max(best, score(evaluate(final_grid, final_lines), weights));
+      }
+      table.store(key, best);
+    }
+    // Topping out (no placement for the next block) stays the lowest score
+    scores[i] = best == lowest ? lowest : best + weights.lines * lines;
+  });
+
+  int best = 0;
+  for (int i = 1; i < num_placements; i++)
+  {
+    if (scores[i] > scores[best])
+    {
+      best = i;
+    }
+  }
+  return root.pathTo(best);
+}
+
+GreedyPlayer::GreedyPlayer(Weights weights)
+: weights(weights)
+{
+}
+
+auto GreedyPlayer::choose(const Grid& grid, const Block& block) -> int
+{
+  int    best       = -1;
+  double best_score = 0;
+  int    count      = moves.generate(grid, block);
+  for (int i = 0; i < count; i++)
+  {
+    Grid   after = grid;
+    int    lines = placeBlock(after, moves.getBlock(i));
+    double value = score(evaluate(after, lines), weights);
+    if (best < 0 || value > best_score)
+    {
+      best       = i;
+      best_score = value;
+    }
+  }
+  return best;
+}
+
+auto GreedyPlayer::getMoves() const -> const MoveGenerator& { return moves; }
+
+auto playGreedyGame(std::uint64_t seed, GreedyPlayer& player, int max_pieces)
+  -> int
+{
+  Engine engine(seed);
+  for (int i = 0; i < max_pieces && !engine.game_over; i++)
+  {
+    int choice = player.choose(engine.grid, engine.getCurrentBlock());
+    if (choice < 0)
+    {
+      break;
+    }
+    engine.place(player.getMoves().getBlock(choice));
+  }
+  return engine.lines;
+}
+
+}  // namespace tetris
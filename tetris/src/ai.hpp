@@ -0,0 +1,138 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "block.hpp"
+#include "engine.hpp"
+#include "grid.hpp"
+#include "thread_pool.hpp"
+#include "transposition.hpp"
+
+namespace tetris
+{
+
+// Heuristic weights, defaults are the well known hand tuned set for
+// height/lines/holes/bumpiness players
+struct Weights
+{
+  double aggregate_height = -0.510066;
+  double lines            = 0.760666;
+  double holes            = -0.35663;
+  double bumpiness        = -0.184483;
+
+  auto operator==(const Weights&) const -> bool = default;
+};
+
+struct Features
+{
+  int aggregate_height;
+  int lines;
+  int holes;
+  int bumpiness;
+};
+
+// Final resting spot of a block, in the same terms as Block's offsets
+struct Placement
+{
+  int rotation;
+  int row_offset;
+  int col_offset;
+};
+
+auto evaluate(const Grid& grid, int lines) -> Features;
+auto score(const Features& features, const Weights& weights) -> double;
+
+// Lock a block into the grid, returning how many rows it cleared
+auto placeBlock(Grid& grid, const Block& block) -> int;
+
+// Breadth first search over every state a block can reach from where it is
+// with left, right, rotate and soft drop. Fixed size tables so generating
+// moves never allocates.
+class MoveGenerator
+{
+public:
+  static const int num_row_offsets = Grid::num_rows + 3;
+  static const int num_col_offsets = Grid::num_cols + 3;
+  static const int max_states      = 4 * num_row_offsets * num_col_offsets;
+
+  // Fills in every final placement of block and returns how many there are
+  auto generate(const Grid& grid, const Block& block) -> int;
+  auto getPlacement(int index) const -> const Placement&;
+  auto getBlock(int index) const -> Block;
+  // Action sequence from the searched block to a placement, ending in a
+  // hard drop
+  auto pathTo(int index) const -> std::vector<Action>;
+
+private:
+  auto stateIndex(int rotation, int row_offset, int col_offset) const -> int;
+  // The search asks about most states several times over, so whether a
+  // state fits is only worked out once per generate()
+  auto fits(const Grid& grid, int rotation, int row_offset, int col_offset)
+    -> bool;
+
+  int                                    block_id;
+  int                                    root;
+  int                                    num_placements;
+  std::array<std::int16_t, max_states>   parent;
+  std::array<Action, max_states>         parent_action;
+  std::array<std::int16_t, max_states>   queue;
+  std::array<Placement, max_states>      placements;
+  std::array<std::int16_t, max_states>   placement_states;
+  // -1 not checked yet, otherwise whether the state fits
+  std::array<std::int8_t, max_states>    fit_cache;
+};
+
+// Picks the best placement for the current block, looking one piece ahead at
+// the next block. The first level of the search is spread over a pool, and
+// the value of each board reached after the first placement is cached so
+// boards that come up again are only searched once.
+class Player
+{
+public:
+  Weights weights;
+
+  explicit Player(ThreadPool& pool,
+                  Weights     weights    = Weights(),
+                  int         table_bits = 16);
+
+  // Actions to play the best placement, empty when the block has nowhere to go
+  auto plan(const Engine& engine) -> std::vector<Action>;
+  auto getTable() const -> const TranspositionTable&;
+
+private:
+  ThreadPool&                                   pool;
+  MoveGenerator                                 root;
+  std::array<double, MoveGenerator::max_states> scores;
+  TranspositionTable                            table;
+  // Weights the cached values were scored with
+  Weights                                       table_weights;
+};
+
+// Scores every placement of the current block by the board it leaves and
+// takes the best, with no lookahead. Far weaker than Player but cheap enough
+// to play millions of games, for generating data and tuning weights. Never
+// allocates.
+class GreedyPlayer
+{
+public:
+  Weights weights;
+
+  explicit GreedyPlayer(Weights weights = Weights());
+
+  // Index of the best placement in getMoves(), -1 when the block has nowhere
+  // to go. Ties go to the first placement found.
+  auto choose(const Grid& grid, const Block& block) -> int;
+  auto getMoves() const -> const MoveGenerator&;
+
+private:
+  MoveGenerator moves;
+};
+
+// Plays a game from seed with the player until it tops out or has placed
+// max_pieces blocks, returning the rows it cleared. Allocates nothing.
+auto playGreedyGame(std::uint64_t seed, GreedyPlayer& player, int max_pieces)
+  -> int;
+
+}  // namespace tetris
@@ -0,0 +1,240 @@
+#include "batch.hpp"
+#include <algorithm>
+#include <array>
+
+namespace tetris
+{
+
+BatchEnv::BatchEnv(int num_boards, std::uint64_t seed)
+: num_boards(num_boards)
+, rows(static_cast<std::size_t>(num_boards) * Grid::num_rows)
+, pieces(num_boards)
+, next_pieces(num_boards)
+, rotations(num_boards)
+, row_offsets(num_boards)
+, col_offsets(num_boards)
+, game_over(num_boards)
+, scores(num_boards)
+{
+  for (int i = 0; i < num_boards; i++)
+  {
+    randomizers.emplace_back(seed + i);
+    resetBoard(i);
+  }
+}
+
+auto BatchEnv::size() const -> int { return num_boards; }
+
+void BatchEnv::step(const Action* actions, int* rewards, std::uint8_t* done)
+{
+  stepRange(0, num_boards, actions, rewards, done);
+}
+
+void BatchEnv::step(const Action* actions,
+                    int*          rewards,
+                    std::uint8_t* done,
+                    ThreadPool&   pool)
+{
+  // A few shards per worker so the ones that finish early can take more
+  int shard_size = std::max(1, num_boards / (pool.size() * 4));
+  int num_shards = (num_boards + shard_size - 1) / shard_size;
+  pool.parallelFor(num_shards, [&](int shard) {
+    int begin = shard * shard_size;
+    int end   = std::min(num_boards, begin + shard_size);
+    stepRange(begin, end, actions, rewards, done);
+  });
+}
+
+void BatchEnv::stepRange(int           begin,
+                         int           end,
+                         const Action* actions,
+                         int*          rewards,
+                         std::uint8_t* done)
+{
+  // Moves first. Locking leaves any full rows in place for the pass below,
+  // which is the same order Engine::lockBlock spawns and clears in.
+  for (int i = begin; i < end; i++)
+  {
+    int before = scores[i];
+    switch (actions[i])
+    {
+      case Action::Left:
+        tryMove(i, 0, -1);
+        break;
+      case Action::Right:
+        tryMove(i, 0, 1);
+        break;
+      case Action::Down:
+        if (tryMove(i, 1, 0))
+        {
+          scores[i] += 1;
+        }
+        else
+        {
+          lock(i);
+        }
+        break;
+      case Action::Rotate:
+        rotate(i);
+        break;
+      case Action::HardDrop:
+      {
+        int distance = 0;
+        while (tryMove(i, 1, 0))
+        {
+          distance++;
+        }
+        scores[i] += distance;
+        lock(i);
+        break;
+      }
+      case Action::Reset:
+        resetBoard(i);
+        before = 0;
+        break;
+    }
+    rewards[i] = scores[i] - before;
+  }
+
+  // Full row detection runs straight over the contiguous row masks of the
+  // whole range with no branches in the inner loop, so it vectorises
+  for (int i = begin; i < end; i++)
+  {
+    Grid::RowMask* board = boardRows(i);
+    int            full  = 0;
+    for (int row = 0; row < Grid::num_rows; row++)
+    {
+      full += board[row] == Grid::full_row;
+    }
+    if (full == 0)
+    {
+      continue;
+    }
+    int target = Grid::num_rows - 1;
+    for (int row = Grid::num_rows - 1; row >= 0; row--)
+    {
+      if (board[row] != Grid::full_row)
+      {
+        board[target--] = board[row];
+      }
+    }
+    std::fill(board, board + target + 1, 0);
+    int points = lineClearScore(full);
+    scores[i] += points;
+    rewards[i] += points;
+  }
+
+  for (int i = begin; i < end; i++)
+  {
+    done[i] = game_over[i];
+    if (game_over[i])
+    {
+      resetBoard(i);
+    }
+  }
+}
+
+auto BatchEnv::fits(int board,
+                    int rotation,
+                    int row_offset,
+                    int col_offset) const -> bool
+{
+  return shapeFits<Grid>(
+    blockRows(pieces[board], rotation), getRows(board), row_offset, col_offset);
+}
+
+auto BatchEnv::tryMove(int board, int down, int across) -> bool
+{
+  int row_offset = row_offsets[board] + down;
+  int col_offset = col_offsets[board] + across;
+  if (!fits(board, rotations[board], row_offset, col_offset))
+  {
+    return false;
+  }
+  row_offsets[board] = static_cast<std::int8_t>(row_offset);
+  col_offsets[board] = static_cast<std::int8_t>(col_offset);
+  return true;
+}
+
+void BatchEnv::rotate(int board)
+{
+  const BlockShape& shape    = blockShape(pieces[board]);
+  const auto&       kicks    = (*shape.kicks)[rotations[board]];
+  int               rotation = (rotations[board] + 1) % shape.num_rotations;
+  for (int i = 0; i < shape.num_kicks; i++)
+  {
+    int row_offset = row_offsets[board] + kicks[i].row;
+    int col_offset = col_offsets[board] + kicks[i].column;
+    if (fits(board, rotation, row_offset, col_offset))
+    {
+      rotations[board]   = static_cast<std::uint8_t>(rotation);
+      row_offsets[board] = static_cast<std::int8_t>(row_offset);
+      col_offsets[board] = static_cast<std::int8_t>(col_offset);
+      return;
+    }
+  }
+}
+
+void BatchEnv::lock(int board)
+{
+  const auto&    masks = blockRows(pieces[board], rotations[board]);
+  Grid::RowMask* grid  = boardRows(board);
+  int            col   = col_offsets[board];
+  for (int i = 0; i < 4; i++)
+  {
+    if (masks[i] != 0)
+    {
+      unsigned mask = col < 0 ? masks[i] >> -col : masks[i] << col;
+      grid[row_offsets[board] + i] |= static_cast<Grid::RowMask>(mask);
+    }
+  }
+  spawn(board, next_pieces[board]);
+  next_pieces[board] = static_cast<std::uint8_t>(randomizers[board].next());
+}
+
+void BatchEnv::spawn(int board, int id)
+{
+  const auto& shape  = blockShape(id);
+  pieces[board]      = static_cast<std::uint8_t>(id);
+  rotations[board]   = 0;
+  row_offsets[board] = static_cast<std::int8_t>(shape.spawn_row);
+  col_offsets[board] = static_cast<std::int8_t>(shape.spawn_col);
+  if (!fits(board, 0, shape.spawn_row, shape.spawn_col))
+  {
+    game_over[board] = 1;
+  }
+}
+
+void BatchEnv::resetBoard(int board)
+{
+  std::fill(boardRows(board), boardRows(board) + Grid::num_rows, 0);
+  game_over[board] = 0;
+  scores[board]    = 0;
+  spawn(board, randomizers[board].next());
+  next_pieces[board] = static_cast<std::uint8_t>(randomizers[board].next());
+}
+
+auto BatchEnv::boardRows(int board) -> Grid::RowMask*
+{
+  return &rows[static_cast<std::size_t>(board) * Grid::num_rows];
+}
+
+auto BatchEnv::getRows(int board) const -> const Grid::RowMask*
+{
+  return &rows[static_cast<std::size_t>(board) * Grid::num_rows];
+}
+
+auto BatchEnv::getBlock(int board) const -> Block
+{
+  return Block(
+    pieces[board], rotations[board], row_offsets[board], col_offsets[board]);
+}
+
+auto BatchEnv::getNextBlockId(int board) const -> int
+{
+  return next_pieces[board];
+}
+
+auto BatchEnv::getScore(int board) const -> int { return scores[board]; }
+
+}  // namespace tetris
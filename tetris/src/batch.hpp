@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "block.hpp"
+#include "engine.hpp"
+#include "grid.hpp"
+#include "randomizer.hpp"
+#include "thread_pool.hpp"
+
+namespace tetris
+{
+
+// Many independent games stepped together, for training and soak runs.
+// Board state is kept as structure of arrays: every board's row masks sit in
+// one contiguous array and the falling block of each board is spread over
+// parallel arrays. A board plays out exactly like an Engine with the same
+// seed fed the same actions, except that it starts over by itself when the
+// game ends. Boards only track occupancy, there is no colour plane.
+class BatchEnv
+{
+public:
+  BatchEnv(int num_boards, std::uint64_t seed);
+
+  auto size() const -> int;
+
+  // Applies actions[i] to board i, writes the score it earned to rewards[i]
+  // and sets done[i] when that board's game ended and was restarted
+  void step(const Action* actions, int* rewards, std::uint8_t* done);
+  // Same, with the boards split into shards spread over the pool
+  void step(const Action* actions,
+            int*          rewards,
+            std::uint8_t* done,
+            ThreadPool&   pool);
+
+  auto getRows(int board) const -> const Grid::RowMask*;
+  auto getBlock(int board) const -> Block;
+  auto getNextBlockId(int board) const -> int;
+  auto getScore(int board) const -> int;
+
+private:
+  void stepRange(int           begin,
+                 int           end,
+                 const Action* actions,
+                 int*          rewards,
+                 std::uint8_t* done);
+  auto fits(int board, int rotation, int row_offset, int col_offset) const
+    -> bool;
+  auto boardRows(int board) -> Grid::RowMask*;
+  auto tryMove(int board, int down, int across) -> bool;
+  void rotate(int board);
+  void lock(int board);
+  void spawn(int board, int id);
+  void resetBoard(int board);
+
+  int num_boards;
+
+  std::vector<Grid::RowMask> rows;
+  std::vector<std::uint8_t>  pieces;
+  std::vector<std::uint8_t>  next_pieces;
+  std::vector<std::uint8_t>  rotations;
+  std::vector<std::int8_t>   row_offsets;
+  std::vector<std::int8_t>   col_offsets;
+  std::vector<std::uint8_t>  game_over;
+  std::vector<int>           scores;
+  std::vector<BagRandomizer> randomizers;
+};
+
+}  // namespace tetris
@@ -1,24 +1,26 @@
 #include "block.hpp"
 
 Block::Block()
+: Block(0)
+{
+}
+
+Block::Block(int id)
+: id(id)
+, shape(&blockShape(id))
 {
-  cell_size  = 30;
   rotation   = 0;
-  row_offset = 0;
-  col_offset = 0;
+  row_offset = shape->spawn_row;
+  col_offset = shape->spawn_col;
 }
 
-void Block::draw()
+Block::Block(int id, int rotation, int row_offset, int col_offset)
+: id(id)
+, shape(&blockShape(id))
+, rotation(rotation)
+, row_offset(row_offset)
+, col_offset(col_offset)
 {
-  auto tiles = getCellPosition();
-  for (const auto& item : tiles)
-  {
-    DrawRectangle(item.column * cell_size + 11,
-                  item.row * cell_size + 11,
-                  cell_size - 1,
-                  cell_size - 1,
-                  Colours[id]);
-  }
 }
 
 void Block::move(int row, int col)
@@ -27,22 +29,35 @@ void Block::move(int row, int col)
   col_offset += col;
 }
 
-auto Block::getCellPosition() -> std::vector<Position>
+auto Block::getCellPosition() const -> Cells
 {
-  std::vector<Position> moved_tiles;
-  std::vector<Position> tiles = cells[rotation];
-  for (const auto& item : tiles)
+  Cells moved_tiles = shape->cells[rotation];
+  for (auto& item : moved_tiles)
   {
-    auto new_pos = Position(item.row + row_offset, item.column + col_offset);
-    moved_tiles.push_back(new_pos);
+    item.row += row_offset;
+    item.column += col_offset;
   }
   return moved_tiles;
 }
 
+auto Block::getRotation() const -> int { return rotation; }
+
+auto Block::getNumRotations() const -> int { return shape->num_rotations; }
+
+auto Block::getRowOffset() const -> int { return row_offset; }
+
+auto Block::getColOffset() const -> int { return col_offset; }
+
+auto Block::getKicks() const -> std::span<const Position>
+{
+  return { (*shape->kicks)[rotation].data(),
+           static_cast<std::size_t>(shape->num_kicks) };
+}
+
 void Block::rotate()
 {
   rotation++;
-  if (rotation == static_cast<int>(cells.size()))
+  if (rotation == shape->num_rotations)
   {
     rotation = 0;
   }
@@ -53,6 +68,6 @@ void Block::undoRotate()
   rotation--;
   if (rotation == -1)
   {
-    rotation = static_cast<int>(cells.size() - 1);
+    rotation = shape->num_rotations - 1;
   }
 }
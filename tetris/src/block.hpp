@@ -1,27 +1,106 @@
 #pragma once
 
-#include "../include/raylib-cpp.hpp"
 #include "grid.hpp"
 #include "position.hpp"
-#include <map>
-#include <vector>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <span>
+
+// SRS wall kicks, the offsets to try in order when turning clockwise out of
+// each rotation state. The first offset that fits is where the block ends up.
+using KickTable = std::array<std::array<Position, 5>, 4>;
+
+// Cell layout of one piece in each of its rotation states, relative to the
+// top left of its bounding box. The tables live in blocks.cpp.
+struct BlockShape
+{
+  int                                     num_rotations;
+  std::array<std::array<Position, 4>, 4> cells;
+  int                                     spawn_row;
+  int                                     spawn_col;
+  int                                     num_kicks;
+  const KickTable*                        kicks;
+};
+
+auto blockShape(int id) -> const BlockShape&;
+
+// The cells of one rotation as a row mask per row of the bounding box, bit n
+// set when column n is filled. Boxes are at most four wide, so the masks fit
+// the narrowest row of any board.
+using ShapeRows = std::array<std::uint16_t, 4>;
+
+// Row masks of every block in every rotation, built from the shape tables at
+// compile time
+auto blockRows(int id, int rotation) -> const ShapeRows&;
+
+// The one fit test every player of the rules shares: whether the shape, its
+// bounding box's top left at row_offset and col_offset, lies inside a board
+// of G's size without touching a filled cell of rows
+template <class G>
+inline auto shapeFits(const ShapeRows&          shape,
+                      const typename G::RowMask* rows,
+                      int                        row_offset,
+                      int                        col_offset) -> bool
+{
+  for (int i = 0; i < 4; i++)
+  {
+    std::uint64_t mask = shape[i];
+    if (mask == 0)
+    {
+      continue;
+    }
+    int row = row_offset + i;
+    if (row < 0 || row >= G::num_rows)
+    {
+      return false;
+    }
+    int shift = col_offset;
+    if (shift < 0)
+    {
+      // Cells shifted off the left edge
+      if ((mask & ((1u << -shift) - 1)) != 0)
+      {
+        return false;
+      }
+      mask >>= -shift;
+      shift = 0;
+    }
+    // Cells past the right edge, checked before shifting so none get shifted
+    // out of a 64 bit row unseen
+    if (shift + static_cast<int>(std::bit_width(mask)) > G::num_cols
+        || ((mask << shift) & rows[row]) != 0)
+    {
+      return false;
+    }
+  }
+  return true;
+}
 
 class Block
 {
 public:
-  int                                  id;
-  std::map<int, std::vector<Position>> cells;
+  using Cells = std::array<Position, 4>;
+
+  int id;
 
   Block();
-  void draw();
+  explicit Block(int id);
+  Block(int id, int rotation, int row_offset, int col_offset);
   void move(int row, int col);
-  auto getCellPosition() -> std::vector<Position>;
+  auto getCellPosition() const -> Cells;
+  auto getRotation() const -> int;
+  auto getNumRotations() const -> int;
+  auto getRowOffset() const -> int;
+  auto getColOffset() const -> int;
+  // Kicks to try for a clockwise turn from the current rotation
+  auto getKicks() const -> std::span<const Position>;
   void rotate();
   void undoRotate();
 
 private:
-  int cell_size;
-  int rotation;
-  int row_offset;
-  int col_offset;
+  const BlockShape* shape;
+  int               rotation;
+  int               row_offset;
+  int               col_offset;
 };
@@ -1,222 +1,169 @@
 #include "block.hpp"
 #include "position.hpp"
 
-class LBlock : public Block
-{
-public:
-  LBlock()
-  {
-    id       = 1;
-    cells[0] = {
-      Position(0, 2),
-      Position(1, 0),
-      Position(1, 1),
-      Position(1, 2),
-    };
-    cells[1] = {
-      Position(0, 1),
-      Position(1, 1),
-      Position(2, 1),
-      Position(2, 2),
-    };
-    cells[2] = {
-      Position(1, 0),
-      Position(1, 1),
-      Position(1, 2),
-      Position(2, 0),
-    };
-    cells[3] = {
-      Position(0, 0),
-      Position(0, 1),
-      Position(1, 1),
-      Position(2, 1),
-    };
-    move(0, 3);
-  }
+// Rotation tables for every piece, indexed by block id. Everything here is
+// built at compile time so moving and rotating a block never allocates.
+
+// SRS kicks as (row, column) with rows counting down, so the guideline's
+// (x, y) offsets appear here as (-y, x)
+static constexpr KickTable no_kicks = {};
+
+static constexpr KickTable jlstz_kicks = { {
+  { Position(0, 0), Position(0, -1), Position(-1, -1), Position(2, 0),
+    Position(2, -1) },
+  { Position(0, 0), Position(0, 1), Position(1, 1), Position(-2, 0),
+    Position(-2, 1) },
+  { Position(0, 0), Position(0, 1), Position(-1, 1), Position(2, 0),
+    Position(2, 1) },
+  { Position(0, 0), Position(0, -1), Position(1, -1), Position(-2, 0),
+    Position(-2, -1) },
+} };
+
+static constexpr KickTable i_kicks = { {
+  { Position(0, 0), Position(0, -2), Position(0, 1), Position(1, -2),
+    Position(-2, 1) },
+  { Position(0, 0), Position(0, -1), Position(0, 2), Position(-2, -1),
+    Position(1, 2) },
+  { Position(0, 0), Position(0, 2), Position(0, -1), Position(-1, 2),
+    Position(2, -1) },
+  { Position(0, 0), Position(0, 1), Position(0, -2), Position(2, 1),
+    Position(-1, -2) },
+} };
+
+static constexpr BlockShape empty_block = {
+  .num_rotations = 1,
+  .cells         = {},
+  .spawn_row     = 0,
+  .spawn_col     = 0,
+  .num_kicks     = 1,
+  .kicks         = &no_kicks,
 };
 
-class JBlock : public Block
-{
-public:
-  JBlock()
-  {
-    id       = 2;
-    cells[0] = {
-      Position(0, 0),
-      Position(1, 0),
-      Position(1, 1),
-      Position(1, 2),
-    };
-    cells[1] = {
-      Position(0, 1),
-      Position(0, 2),
-      Position(1, 1),
-      Position(2, 1),
-    };
-    cells[2] = {
-      Position(1, 0),
-      Position(1, 1),
-      Position(1, 2),
-      Position(2, 2),
-    };
-    cells[3] = {
-      Position(0, 1),
-      Position(1, 1),
-      Position(2, 0),
-      Position(2, 1),
-    };
-    move(0, 3);
-  }
+static constexpr BlockShape l_block = {
+  .num_rotations = 4,
+  .cells         = { {
+    { Position(0, 2), Position(1, 0), Position(1, 1), Position(1, 2) },
+    { Position(0, 1), Position(1, 1), Position(2, 1), Position(2, 2) },
+    { Position(1, 0), Position(1, 1), Position(1, 2), Position(2, 0) },
+    { Position(0, 0), Position(0, 1), Position(1, 1), Position(2, 1) },
+  } },
+  .spawn_row     = 0,
+  .spawn_col     = 3,
+  .num_kicks     = 5,
+  .kicks         = &jlstz_kicks,
 };
 
-class IBlock : public Block
-{
-public:
-  IBlock()
-  {
-    id       = 3;
-    cells[0] = {
-      Position(1, 0),
-      Position(1, 1),
-      Position(1, 2),
-      Position(1, 3),
-    };
-    cells[1] = {
-      Position(0, 2),
-      Position(1, 2),
-      Position(2, 2),
-      Position(3, 2),
-    };
-    cells[2] = {
-      Position(2, 0),
-      Position(2, 1),
-      Position(2, 2),
-      Position(2, 3),
-    };
-    cells[3] = {
-      Position(0, 1),
-      Position(1, 1),
-      Position(2, 1),
-      Position(3, 1),
-    };
-    move(-1, 3);
-  }
+static constexpr BlockShape j_block = {
+  .num_rotations = 4,
+  .cells         = { {
+    { Position(0, 0), Position(1, 0), Position(1, 1), Position(1, 2) },
+    { Position(0, 1), Position(0, 2), Position(1, 1), Position(2, 1) },
+    { Position(1, 0), Position(1, 1), Position(1, 2), Position(2, 2) },
+    { Position(0, 1), Position(1, 1), Position(2, 0), Position(2, 1) },
+  } },
+  .spawn_row     = 0,
+  .spawn_col     = 3,
+  .num_kicks     = 5,
+  .kicks         = &jlstz_kicks,
 };
 
-class OBlock : public Block
-{
-public:
-  OBlock()
-  {
-    id       = 4;
-    cells[0] = {
-      Position(0, 0),
-      Position(0, 1),
-      Position(1, 0),
-      Position(1, 1),
-    };
-    move(0, 4);
-  }
+static constexpr BlockShape i_block = {
+  .num_rotations = 4,
+  .cells         = { {
+    { Position(1, 0), Position(1, 1), Position(1, 2), Position(1, 3) },
+    { Position(0, 2), Position(1, 2), Position(2, 2), Position(3, 2) },
+    { Position(2, 0), Position(2, 1), Position(2, 2), Position(2, 3) },
+    { Position(0, 1), Position(1, 1), Position(2, 1), Position(3, 1) },
+  } },
+  .spawn_row     = -1,
+  .spawn_col     = 3,
+  .num_kicks     = 5,
+  .kicks         = &i_kicks,
 };
 
-class SBlock : public Block
-{
-public:
-  SBlock()
-  {
-    id       = 5;
-    cells[0] = {
-      Position(0, 1),
-      Position(0, 2),
-      Position(1, 0),
-      Position(1, 1),
-    };
-    cells[1] = {
-      Position(0, 1),
-      Position(1, 1),
-      Position(1, 2),
-      Position(2, 2),
-    };
-    cells[2] = {
-      Position(1, 1),
-      Position(1, 2),
-      Position(2, 0),
-      Position(2, 1),
-    };
-    cells[3] = {
-      Position(0, 0),
-      Position(1, 0),
-      Position(1, 1),
-      Position(2, 1),
-    };
-    move(0, 3);
-  }
+static constexpr BlockShape o_block = {
+  .num_rotations = 1,
+  .cells         = { {
+    { Position(0, 0), Position(0, 1), Position(1, 0), Position(1, 1) },
+  } },
+  .spawn_row     = 0,
+  .spawn_col     = 4,
+  .num_kicks     = 1,
+  .kicks         = &no_kicks,
 };
 
-class TBlock : public Block
-{
-public:
-  TBlock()
-  {
-    id       = 6;
-    cells[0] = {
-      Position(0, 1),
-      Position(1, 0),
-      Position(1, 1),
-      Position(1, 2),
-    };
-    cells[1] = {
-      Position(0, 1),
-      Position(1, 1),
-      Position(1, 2),
-      Position(2, 1),
-    };
-    cells[2] = {
-      Position(1, 0),
-      Position(1, 1),
-      Position(1, 2),
-      Position(2, 1),
-    };
-    cells[3] = {
-      Position(0, 1),
-      Position(1, 0),
-      Position(1, 1),
-      Position(2, 1),
-    };
-    move(0, 3);
-  }
+static constexpr BlockShape s_block = {
+  .num_rotations = 4,
+  .cells         = { {
+    { Position(0, 1), Position(0, 2), Position(1, 0), Position(1, 1) },
+    { Position(0, 1), Position(1, 1), Position(1, 2), Position(2, 2) },
+    { Position(1, 1), Position(1, 2), Position(2, 0), Position(2, 1) },
+    { Position(0, 0), Position(1, 0), Position(1, 1), Position(2, 1) },
+  } },
+  .spawn_row     = 0,
+  .spawn_col     = 3,
+  .num_kicks     = 5,
+  .kicks         = &jlstz_kicks,
+};
+
+static constexpr BlockShape t_block = {
+  .num_rotations = 4,
+  .cells         = { {
+    { Position(0, 1), Position(1, 0), Position(1, 1), Position(1, 2) },
+    { Position(0, 1), Position(1, 1), Position(1, 2), Position(2, 1) },
+    { Position(1, 0), Position(1, 1), Position(1, 2), Position(2, 1) },
+    { Position(0, 1), Position(1, 0), Position(1, 1), Position(2, 1) },
+  } },
+  .spawn_row     = 0,
+  .spawn_col     = 3,
+  .num_kicks     = 5,
+  .kicks         = &jlstz_kicks,
+};
+
+static constexpr BlockShape z_block = {
+  .num_rotations = 4,
+  .cells         = { {
+    { Position(0, 0), Position(0, 1), Position(1, 1), Position(1, 2) },
+    { Position(0, 2), Position(1, 1), Position(1, 2), Position(2, 1) },
+    { Position(1, 0), Position(1, 1), Position(2, 1), Position(2, 2) },
+    { Position(0, 1), Position(1, 0), Position(1, 1), Position(2, 0) },
+  } },
+  .spawn_row     = 0,
+  .spawn_col     = 3,
+  .num_kicks     = 5,
+  .kicks         = &jlstz_kicks,
+};
+
+static constexpr std::array<const BlockShape*, 8> block_shapes = {
+  &empty_block, &l_block, &j_block, &i_block,
+  &o_block,     &s_block, &t_block, &z_block,
 };
 
-class ZBlock : public Block
+auto blockShape(int id) -> const BlockShape& { return *block_shapes[id]; }
+
+using BlockRows = std::array<std::array<ShapeRows, 4>, 8>;
+
+static constexpr auto buildBlockRows() -> BlockRows
 {
-public:
-  ZBlock()
+  BlockRows rows = {};
+  for (int id = 1; id < 8; id++)
   {
-    id       = 7;
-    cells[0] = {
-      Position(0, 0),
-      Position(0, 1),
-      Position(1, 1),
-      Position(1, 2),
-    };
-    cells[1] = {
-      Position(0, 2),
-      Position(1, 1),
-      Position(1, 2),
-      Position(2, 1),
-    };
-    cells[2] = {
-      Position(1, 0),
-      Position(1, 1),
-      Position(2, 1),
-      Position(2, 2),
-    };
-    cells[3] = {
-      Position(0, 1),
-      Position(1, 0),
-      Position(1, 1),
-      Position(2, 0),
-    };
-    move(0, 3);
+    const BlockShape& shape = *block_shapes[id];
+    for (int rotation = 0; rotation < shape.num_rotations; rotation++)
+    {
+      for (const auto& cell : shape.cells[rotation])
+      {
+        rows[id][rotation][cell.row] |= static_cast<std::uint16_t>(
+          1u << cell.column);
+      }
+    }
   }
-};
\ No newline at end of file
+  return rows;
+}
+
+static constexpr BlockRows block_rows = buildBlockRows();
+
+auto blockRows(int id, int rotation) -> const ShapeRows&
+{
+  return block_rows[id][rotation];
+}
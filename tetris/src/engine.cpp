@@ -0,0 +1,283 @@
+#include "engine.hpp"
+
+namespace tetris
+{
+
+template <class G>
+BasicEngine<G>::BasicEngine(std::uint64_t seed)
+: randomizer(seed)
+{
+  current_block = getRandomBlock();
+  next_block    = getRandomBlock();
+  game_over     = false;
+  score         = 0;
+  lines         = 0;
+  spawns        = 0;
+}
+
+template <class G>
+auto BasicEngine<G>::getRandomBlock() -> Block
+{
+  // Spawn columns are set for the standard board, wider boards shift them
+  // over so blocks still spawn in the middle
+  Block block(randomizer.next());
+  block.move(0, (G::num_cols - Grid::num_cols) / 2);
+  return block;
+}
+
+template <class G>
+void BasicEngine<G>::step(Action action)
+{
+  switch (action)
+  {
+    case Action::Left:
+      moveBlockLeft();
+      break;
+    case Action::Right:
+      moveBlockRight();
+      break;
+    case Action::Down:
+      moveBlockDown();
+      break;
+    case Action::Rotate:
+      rotateBlock();
+      break;
+    case Action::HardDrop:
+      hardDrop();
+      break;
+    case Action::Reset:
+      reset();
+      break;
+  }
+}
+
+template <class G>
+void BasicEngine<G>::moveBlockLeft()
+{
+  if (!game_over)
+  {
+    current_block.move(0, -1);
+    if (!blockFits())
+    {
+      current_block.move(0, 1);
+    }
+  }
+}
+
+template <class G>
+void BasicEngine<G>::moveBlockRight()
+{
+  if (!game_over)
+  {
+    current_block.move(0, 1);
+    if (!blockFits())
+    {
+      current_block.move(0, -1);
+    }
+  }
+}
+
+template <class G>
+void BasicEngine<G>::moveBlockDown()
+{
+  if (!game_over)
+  {
+    current_block.move(1, 0);
+    if (!blockFits())
+    {
+      current_block.move(-1, 0);
+      lockBlock();
+      return;
+    }
+    updateScore(0, 1);
+  }
+}
+
+template <class G>
+void BasicEngine<G>::rotateBlock()
+{
+  if (!game_over)
+  {
+    auto kicks = current_block.getKicks();
+    current_block.rotate();
+    for (const auto& kick : kicks)
+    {
+      current_block.move(kick.row, kick.column);
+      if (blockFits())
+      {
+        return;
+      }
+      current_block.move(-kick.row, -kick.column);
+    }
+    current_block.undoRotate();
+  }
+}
+
+template <class G>
+void BasicEngine<G>::hardDrop()
+{
+  if (!game_over)
+  {
+    int distance = getDropDistance();
+    current_block.move(distance, 0);
+    updateScore(0, distance);
+    lockBlock();
+  }
+}
+
+template <class G>
+void BasicEngine<G>::place(const Block& block)
+{
+  if (!game_over)
+  {
+    updateScore(0, block.getRowOffset() - current_block.getRowOffset());
+    current_block = block;
+    lockBlock();
+  }
+}
+
+template <class G>
+auto BasicEngine<G>::isBlockOutside() const -> bool
+{
+  auto tiles = current_block.getCellPosition();
+  for (const auto& item : tiles)
+  {
+    if (grid.isCellOutside(item.row, item.column))
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+template <class G>
+void BasicEngine<G>::lockBlock()
+{
+  auto tiles = current_block.getCellPosition();
+  for (const auto& item : tiles)
+  {
+    grid.setCell(item.row, item.column, current_block.id);
+  }
+  current_block = next_block;
+  spawns++;
+  if (blockFits() == false)
+  {
+    game_over = true;
+  }
+  next_block       = getRandomBlock();
+  int rows_cleared = grid.clearFullRoads();
+  lines += rows_cleared;
+  updateScore(rows_cleared, 0);
+}
+
+template <class G>
+auto BasicEngine<G>::blockFits() const -> bool
+{
+  return shapeFits<G>(blockRows(current_block.id, current_block.getRotation()),
+                      grid.rowMasks(),
+                      current_block.getRowOffset(),
+                      current_block.getColOffset());
+}
+
+template <class G>
+auto BasicEngine<G>::getDropDistance() const -> int
+{
+  return grid.dropDistance(current_block.getCellPosition());
+}
+
+template <class G>
+auto BasicEngine<G>::getCurrentBlock() const -> const Block&
+{
+  return current_block;
+}
+
+template <class G>
+auto BasicEngine<G>::getNextBlock() const -> const Block& { return next_block; }
+
+template <class G>
+void BasicEngine<G>::reset()
+{
+  grid.initialize();
+  current_block = getRandomBlock();
+  next_block    = getRandomBlock();
+  game_over     = false;
+  score         = 0;
+  lines         = 0;
+  spawns++;
+}
+
+template <class G>
+void BasicEngine<G>::addGarbage(int lines, int hole_column)
+{
+  if (game_over || lines <= 0)
+  {
+    return;
+  }
+  if (!grid.addGarbage(lines, hole_column, garbage_colour))
+  {
+    game_over = true;
+    return;
+  }
+  for (int lifted = 0; !blockFits() && lifted < lines; lifted++)
+  {
+    current_block.move(-1, 0);
+    if (isBlockOutside())
+    {
+      game_over = true;
+      return;
+    }
+  }
+  if (!blockFits())
+  {
+    game_over = true;
+  }
+}
+
+template <class G>
+auto BasicEngine<G>::save() const -> BasicGameState<G>
+{
+  return {
+    grid,  randomizer, current_block, next_block,
+    score, lines,      spawns,        game_over,
+  };
+}
+
+template <class G>
+void BasicEngine<G>::restore(const BasicGameState<G>& state)
+{
+  grid          = state.grid;
+  randomizer    = state.randomizer;
+  current_block = state.current_block;
+  next_block    = state.next_block;
+  score         = state.score;
+  lines         = state.lines;
+  spawns        = state.spawns;
+  game_over     = state.game_over;
+}
+
+auto lineClearScore(int lines_cleared) -> int
+{
+  switch (lines_cleared)
+  {
+    case 1:
+      return 100;
+    case 2:
+      return 300;
+    case 3:
+      return 500;
+    default:
+      return 0;
+  }
+}
+
+template <class G>
+void BasicEngine<G>::updateScore(int lines_cleared, int move_down_points)
+{
+  score += lineClearScore(lines_cleared) + move_down_points;
+}
+
+template class BasicEngine<Grid>;
+template class BasicEngine<BasicGrid<20, 32>>;
+template class BasicEngine<BasicGrid<20, 64>>;
+
+}  // namespace tetris
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <cstdint>
+#include <type_traits>
+
+#include "block.hpp"
+#include "grid.hpp"
+#include "randomizer.hpp"
+
+namespace tetris
+{
+
+enum class Action : std::uint8_t
+{
+  Left,
+  Right,
+  Down,
+  Rotate,
+  HardDrop,
+  Reset,
+};
+
+// Points for clearing this many rows with one block
+auto lineClearScore(int lines_cleared) -> int;
+
+// Colour of garbage rows in versus mode, one past the block ids
+static const int garbage_colour = 8;
+
+// Everything that makes up a game in progress as one flat value, so saving and
+// restoring a game is a single fixed size copy
+template <class G>
+struct BasicGameState
+{
+  G             grid;
+  BagRandomizer randomizer;
+  Block         current_block;
+  Block         next_block;
+  int           score;
+  int           lines;
+  int           spawns;
+  bool          game_over;
+};
+
+// The rules of the game with no window, input or drawing attached, on a board
+// of type G. Front ends feed it actions and read the grid and blocks back out
+// to render them.
+template <class G>
+class BasicEngine
+{
+public:
+  G    grid;
+  int  score;
+  // Rows cleared this game
+  int  lines;
+  // Blocks dealt since the engine was made, counting the new block after
+  // every lock and reset, so front ends can tell when a block starts
+  int  spawns;
+  bool game_over;
+
+  // The seed fixes the whole piece sequence, so the same seed and actions
+  // always play out the same game
+  explicit BasicEngine(std::uint64_t seed);
+
+  void step(Action action);
+  void moveBlockLeft();
+  void moveBlockRight();
+  void moveBlockDown();
+  void rotateBlock();
+  void hardDrop();
+  // Locks block in as the current block, for players that pick a final
+  // placement instead of steering there. Scores like dropping the current
+  // block down to it.
+  void place(const Block& block);
+  void reset();
+  // Versus mode: pushes garbage rows in from the bottom, lifting the falling
+  // block clear of them if it can. Tops out when that fails or filled cells
+  // get pushed off the top.
+  void addGarbage(int lines, int hole_column);
+  auto save() const -> BasicGameState<G>;
+  void restore(const BasicGameState<G>& state);
+  // Whether the current block is inside the grid and clear of locked cells
+  auto blockFits() const -> bool;
+  // Rows the current block can fall before it lands
+  auto getDropDistance() const -> int;
+  auto getCurrentBlock() const -> const Block&;
+  auto getNextBlock() const -> const Block&;
+
+private:
+  auto getRandomBlock() -> Block;
+  auto isBlockOutside() const -> bool;
+  void lockBlock();
+  void updateScore(int lines_cleared, int move_down_points);
+
+  BagRandomizer randomizer;
+  Block         current_block;
+  Block         next_block;
+};
+
+// The standard board everything but the tests plays on
+using GameState = BasicGameState<Grid>;
+using Engine    = BasicEngine<Grid>;
+
+static_assert(std::is_trivially_copyable_v<GameState>);
+
+// The rules are compiled in engine.cpp for the standard board and the 32 and
+// 64 bit row widths
+extern template class BasicEngine<Grid>;
+extern template class BasicEngine<BasicGrid<20, 32>>;
+extern template class BasicEngine<BasicGrid<20, 64>>;
+
+}  // namespace tetris
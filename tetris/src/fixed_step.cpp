@@ -0,0 +1,49 @@
+#include "fixed_step.hpp"
+
+namespace tetris
+{
+
+FixedStep::FixedStep(double tick_rate, int max_catch_up)
+: tick_interval(1.0 / tick_rate)
+, accumulator(0)
+, last_time(0)
+, started(false)
+, max_catch_up(max_catch_up)
+, dropped_ticks(0)
+{
+}
+
+void FixedStep::setTickRate(double tick_rate)
+{
+  tick_interval = 1.0 / tick_rate;
+}
+
+auto FixedStep::getTickRate() const -> double { return 1.0 / tick_interval; }
+
+auto FixedStep::advance(double now) -> int
+{
+  if (!started)
+  {
+    started   = true;
+    last_time = now;
+    return 0;
+  }
+  accumulator += now - last_time;
+  last_time = now;
+
+  auto ticks = static_cast<long>(accumulator / tick_interval);
+  if (ticks > max_catch_up)
+  {
+    dropped_ticks += ticks - max_catch_up;
+    accumulator -= (ticks - max_catch_up) * tick_interval;
+    ticks = max_catch_up;
+  }
+  accumulator -= ticks * tick_interval;
+  return static_cast<int>(ticks);
+}
+
+auto FixedStep::alpha() const -> double { return accumulator / tick_interval; }
+
+auto FixedStep::getDroppedTicks() const -> long { return dropped_ticks; }
+
+}  // namespace tetris
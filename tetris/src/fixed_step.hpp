@@ -0,0 +1,34 @@
+#pragma once
+
+namespace tetris
+{
+
+// Fixed timestep scheduler. Wall clock time goes into an accumulator and
+// comes out as whole simulation ticks at a set rate, however fast or slow
+// frames are. A slow frame is made up for with extra ticks on the next one,
+// up to a limit so a long stall (a debugger, a dragged window) doesn't lock
+// the game up replaying it; ticks past the limit are dropped and counted.
+class FixedStep
+{
+public:
+  explicit FixedStep(double tick_rate, int max_catch_up = 8);
+
+  void setTickRate(double tick_rate);
+  auto getTickRate() const -> double;
+  // Feeds in the current time in seconds and returns how many ticks are due
+  auto advance(double now) -> int;
+  // How far the simulation is into the next tick, 0 to 1, for interpolating
+  // what gets drawn between ticks
+  auto alpha() const -> double;
+  auto getDroppedTicks() const -> long;
+
+private:
+  double tick_interval;
+  double accumulator;
+  double last_time;
+  bool   started;
+  int    max_catch_up;
+  long   dropped_ticks;
+};
+
+}  // namespace tetris
@@ -1,188 +1,247 @@
 #include "game.hpp"
-#include "blocks.cpp"
+#include <algorithm>
+#include <string>
 
-Game::Game()
+static auto samePlacement(const Block& a, const Block& b) -> bool
 {
-  grid          = Grid();
-  blocks        = getAllBlocks();
-  current_block = getRandomBlock();
-  next_block    = getRandomBlock();
-  game_over     = false;
-  score         = 0;
+  return a.id == b.id && a.getRotation() == b.getRotation()
+         && a.getRowOffset() == b.getRowOffset()
+         && a.getColOffset() == b.getColOffset();
 }
 
-auto Game::getRandomBlock() -> Block
+Game::Game(std::uint64_t seed, int gravity_ticks)
+: engine(seed)
+, replay(seed)
+, autoplay(false)
+, frame(0)
+, gravity_ticks(gravity_ticks)
+, gravity_counter(0)
+, player(pool)
+, cache(LoadRenderTexture(GetScreenWidth(), GetScreenHeight()))
+, cache_dirty(true)
+, block_start { engine.save(), 0 }
 {
-  if (blocks.empty())
+  updateGhost();
+}
+
+Game::~Game() { UnloadRenderTexture(cache); }
+
+void Game::apply(tetris::Action action)
+{
+  int spawns = engine.spawns;
+  int lines  = engine.lines;
+  replay.record(frame, action);
+  engine.step(action);
+  updateGhost();
+  // A new block starts when the last one locks or the game resets
+  if (engine.spawns != spawns)
   {
-    blocks = getAllBlocks();
+    if (action != tetris::Action::Reset)
+    {
+      stats.countLock(engine.lines - lines);
+    }
+    cache_dirty = true;
+    // The plan was for the block that just locked
+    plan.clear();
+    history.push(block_start);
+    block_start = { engine.save(), replay.events.size() };
   }
-  auto index = GetRandomValue(0, static_cast<int>(blocks.size()) - 1);
-  auto block = blocks[index];
-  blocks.erase(blocks.begin() + index);
-  return block;
 }
 
-auto Game::getAllBlocks() -> std::vector<Block>
+auto Game::undo() -> bool
 {
-  return {
-    TBlock(), IBlock(), JBlock(), LBlock(), OBlock(), SBlock(), ZBlock()
-  };
+  if (!history.pop(block_start))
+  {
+    return false;
+  }
+  engine.restore(block_start.state);
+  replay.events.resize(block_start.replay_events);
+  previous_block = engine.getCurrentBlock();
+  updateGhost();
+  plan.clear();
+  cache_dirty = true;
+  return true;
 }
 
-void Game::draw()
+void Game::setAutoplayWeights(const tetris::Weights& weights)
 {
-  grid.draw();
-  current_block.draw();
+  player.weights = weights;
+  plan.clear();
 }
 
-void Game::handleInput()
+void Game::refreshCache()
 {
-  int key_pressed = GetKeyPressed();
-
-  if (game_over && key_pressed != 0)
-  {
-    game_over = false;
-    reset();
-  }
-
-  switch (key_pressed)
+  if (!cache_dirty)
   {
-    case KEY_LEFT:
-      moveBlockLeft();
-      break;
-    case KEY_RIGHT:
-      moveBlockRight();
-      break;
-    case KEY_DOWN:
-      moveBlockDown();
-      break;
-    case KEY_UP:
-      rotateBlock();
-      break;
-    default:
-      break;
+    return;
   }
+  BeginTextureMode(cache);
+  drawStatic();
+  drawGrid();
+  stats.countBatch();
+  EndTextureMode();
+  cache_dirty = false;
+  stats.countCacheRedraw();
 }
 
-void Game::moveBlockLeft()
+void Game::drawStatic()
 {
-  if (!game_over)
-  {
-    current_block.move(0, -1);
-    if (isBlockOutside() || blockFits() == false)
-    {
-      current_block.move(0, 1);
-    }
-  }
+  ClearBackground(DARKGRAY);
+  DrawRectangleRounded({ panel_x, 55, 170, 60 }, 0.3, 6, GRAY);
+  DrawRectangleRounded({ panel_x, 250, 170, 180 }, 0.3, 6, GRAY);
+  drawText("Score", panel_x + 45, 15);
+  drawText("Next", panel_x + 50, 175);
 }
 
-void Game::moveBlockRight()
+void Game::drawText(const std::string& text, int x, int y)
 {
-  if (!game_over)
-  {
-    current_block.move(0, 1);
-    if (isBlockOutside() || blockFits() == false)
-    {
-      current_block.move(0, -1);
-    }
-  }
+  raylib::DrawText(text, x, y, 38, RAYWHITE);
 }
 
-void Game::moveBlockDown()
+void Game::draw(double alpha)
 {
-  if (!game_over)
+  // Render textures are stored upside down
+  auto width  = static_cast<float>(cache.texture.width);
+  auto height = static_cast<float>(cache.texture.height);
+  DrawTextureRec(cache.texture, { 0, 0, width, -height }, { 0, 0 }, WHITE);
+
+  drawText(std::to_string(engine.score), panel_x + 13, 65);
+  if (engine.game_over)
   {
-    current_block.move(1, 0);
-    if (isBlockOutside() || blockFits() == false)
-    {
-      current_block.move(-1, 0);
-      lockBlock();
-      return;
-    }
-    updateScore(0, 1);
+    drawText("GAME OVER", panel_x, 450);
   }
-}
 
-void Game::rotateBlock()
-{
-  if (!game_over)
+  // Only a plain one row fall is eased, anything else snaps into place
+  const Block& block    = engine.getCurrentBlock();
+  float        y_offset = 0;
+  if (block.id == previous_block.id
+      && block.getRotation() == previous_block.getRotation()
+      && block.getColOffset() == previous_block.getColOffset()
+      && block.getRowOffset() == previous_block.getRowOffset() + 1)
   {
-    current_block.rotate();
+    y_offset = -static_cast<float>((1.0 - alpha) * cell_size);
   }
-  if (isBlockOutside() || blockFits() == false)
+  if (!engine.game_over)
   {
-    current_block.undoRotate();
+    drawBlock(ghost_block, 0, 0.3f);
   }
+  drawBlock(block, y_offset);
+  stats.draw(panel_x, 500);
 }
 
-auto Game::isBlockOutside() -> bool
+void Game::updateGhost()
 {
-  auto tiles = current_block.getCellPosition();
-  for (const auto& item : tiles)
+  ghost_block = engine.getCurrentBlock();
+  ghost_block.move(engine.getDropDistance(), 0);
+}
+
+void Game::drawGrid()
+{
+  for (int row = 0; row < Grid::num_rows; row++)
   {
-    if (grid.isCellOutside(item.row, item.column))
+    for (int col = 0; col < Grid::num_cols; col++)
     {
-      return true;
+      int cell_value = engine.grid.getCell(row, col);
+      DrawRectangle(board_x + col * cell_size,
+                    board_y + row * cell_size,
+                    cell_size - 1,
+                    cell_size - 1,
+                    Colours[cell_value]);
     }
   }
-  return false;
 }
 
-void Game::lockBlock()
+void Game::drawBlock(const Block& block, float y_offset, float opacity)
 {
-  auto tiles = current_block.getCellPosition();
+  auto tiles = block.getCellPosition();
   for (const auto& item : tiles)
   {
-    grid.grid[item.row][item.column] = current_block.id;
-  }
-  current_block = next_block;
-  if (blockFits() == false)
-  {
-    game_over = true;
+    DrawRectangleRec({ static_cast<float>(board_x + item.column * cell_size),
+                       static_cast<float>(board_y + item.row * cell_size)
+                         + y_offset,
+                       cell_size - 1,
+                       cell_size - 1 },
+                     Fade(Colours[block.id], opacity));
   }
-  next_block       = getRandomBlock();
-  int rows_cleared = grid.clearFullRoads();
-  updateScore(rows_cleared, 0);
 }
 
-auto Game::blockFits() -> bool
+void Game::handleInput()
 {
-  auto tiles = current_block.getCellPosition();
-  for (const auto& item : tiles)
+  int key_pressed = GetKeyPressed();
+
+  if (engine.game_over && key_pressed != 0 && key_pressed != KEY_Z
+      && key_pressed != KEY_F3)
   {
-    if (grid.isCellEmpty(item.row, item.column) == false)
-    {
-      return false;
-    }
+    apply(tetris::Action::Reset);
   }
-  return true;
-}
 
-void Game::reset()
-{
-  grid.initialize();
-  blocks        = getAllBlocks();
-  current_block = getRandomBlock();
-  next_block    = getRandomBlock();
-  score         = 0;
-}
-
-void Game::updateScore(int lines_cleared, int move_down_points)
-{
-  switch (lines_cleared)
+  switch (key_pressed)
   {
-    case 1:
-      score += 100;
+    case KEY_LEFT:
+      apply(tetris::Action::Left);
+      break;
+    case KEY_RIGHT:
+      apply(tetris::Action::Right);
+      break;
+    case KEY_DOWN:
+      apply(tetris::Action::Down);
       break;
-    case 2:
-      score += 300;
+    case KEY_UP:
+      apply(tetris::Action::Rotate);
+      break;
+    case KEY_SPACE:
+      apply(tetris::Action::HardDrop);
+      break;
+    case KEY_A:
+      autoplay = !autoplay;
+      plan.clear();
       break;
-    case 3:
-      score += 500;
+    case KEY_Z:
+      undo();
+      break;
+    case KEY_F3:
+      stats.visible = !stats.visible;
       break;
     default:
       break;
   }
-  score += move_down_points;
+}
+
+void Game::tick()
+{
+  frame++;
+  previous_block = engine.getCurrentBlock();
+
+  if (++gravity_counter >= gravity_ticks)
+  {
+    gravity_counter = 0;
+    apply(tetris::Action::Down);
+  }
+
+  if (!autoplay)
+  {
+    return;
+  }
+  if (engine.game_over)
+  {
+    apply(tetris::Action::Reset);
+  }
+  // Gravity or a key press moved the block off the planned path, or a new
+  // block spawned, so the rest of the plan no longer leads anywhere useful
+  if (!plan.empty() && !samePlacement(engine.getCurrentBlock(), plan_block))
+  {
+    plan.clear();
+  }
+  if (plan.empty())
+  {
+    plan = player.plan(engine);
+    // Actions are popped off the back
+    std::reverse(plan.begin(), plan.end());
+  }
+  if (!plan.empty())
+  {
+    apply(plan.back());
+    plan.pop_back();
+    plan_block = engine.getCurrentBlock();
+  }
 }
@@ -1,37 +1,102 @@
 #pragma once
 
 #include "../include/raylib-cpp.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <string>
 #include <vector>
 
-#include "block.hpp"
-#include "grid.hpp"
+#include "ai.hpp"
+#include "engine.hpp"
+#include "replay.hpp"
+#include "ring_buffer.hpp"
+#include "stats.hpp"
 
+static const std::vector<Color> Colours = {
+  RAYWHITE, GREEN, RED, ORANGE, YELLOW, PURPLE, SKYBLUE, BLUE, LIGHTGRAY,
+};
+
+// raylib front end: turns key presses into engine actions and draws the
+// engine state. All of the rules live in tetris::Engine.
+//
+// The background, panels, labels and locked cells only change when a block
+// locks or rows clear, so they are drawn once into a render texture and
+// redrawn only when the board changes. Each frame composites that texture
+// with the score and the falling block.
 class Game
 {
 public:
-  Grid grid;
+  tetris::Engine engine;
+  tetris::Replay replay;
+  FrameStats     stats;
+  bool           autoplay;
 
-  Game();
+  // Gravity pulls the block down one row every gravity_ticks ticks
+  Game(std::uint64_t seed, int gravity_ticks);
+  ~Game();
 
-  auto getRandomBlock() -> Block;
-  auto getAllBlocks() -> std::vector<Block>;
-  void draw();
+  // Steps the engine and records the action for the replay
+  void apply(tetris::Action action);
+  // Redraws the cached board if it changed, call before BeginDrawing
+  void refreshCache();
+  // alpha is how far the simulation is into the next tick, used to ease the
+  // falling block down between gravity steps
+  void draw(double alpha);
+  // Turns the key presses polled this frame into actions
   void handleInput();
-  void moveBlockLeft();
-  void moveBlockRight();
-  void moveBlockDown();
+  // One fixed simulation step: gravity and, while autoplay is on, one action
+  // from the AI's plan
+  void tick();
+  // Takes back the last placed block, false when there is nothing to undo
+  auto undo() -> bool;
+  // Weights the autoplayer scores boards with, e.g. from make tune
+  void setAutoplayWeights(const tetris::Weights& weights);
 
-  int score;
-  bool game_over;
+private:
+  static const int cell_size = 30;
+  // The board's top left corner and size, the side panel sits to its right
+  static const int board_x      = 11;
+  static const int board_y      = 11;
+  static const int board_width  = Grid::num_cols * cell_size;
+  static const int board_height = Grid::num_rows * cell_size;
+  static const int panel_x      = board_x + board_width + 9;
+
+public:
+  // Window size that fits the board and panel
+  static const int screen_width  = panel_x + 180;
+  static const int screen_height = board_y + board_height + 9;
 
 private:
-  auto isBlockOutside() -> bool;
-  auto blockFits() -> bool;
-  void rotateBlock();
-  void lockBlock();
-  void reset();
-  void updateScore(int lines_cleared, int move_down_points);
-  std::vector<Block> blocks;
-  Block              current_block;
-  Block              next_block;
+
+  // Game state at the start of a block, plus how much of the replay had been
+  // recorded by then so undoing drops the undone actions from it too
+  struct Checkpoint
+  {
+    tetris::GameState state;
+    std::size_t       replay_events;
+  };
+
+  std::uint32_t               frame;
+  int                         gravity_ticks;
+  int                         gravity_counter;
+  Block                       previous_block;
+  // Where the current block would land, moved whenever the engine steps
+  Block                       ghost_block;
+  tetris::ThreadPool          pool;
+  tetris::Player              player;
+  std::vector<tetris::Action> plan;
+  // Where the plan left the block, checked before playing the next action
+  Block                       plan_block;
+  RenderTexture2D             cache;
+  bool                        cache_dirty;
+  Checkpoint                  block_start;
+
+  // Start of each of the last few blocks, newest on top
+  tetris::RingBuffer<Checkpoint, 256> history;
+
+  void drawStatic();
+  void drawGrid();
+  void updateGhost();
+  void drawText(const std::string& text, int x, int y);
+  void drawBlock(const Block& block, float y_offset, float opacity = 1.0f);
 };
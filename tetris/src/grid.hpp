@@ -1,33 +1,304 @@
 #pragma once
 
-#include "../include/raylib-cpp.hpp"
-#include <map>
-#include <vector>
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <type_traits>
 
-static const std::vector<Color> Colours = {
-  RAYWHITE, GREEN, RED, ORANGE, YELLOW, PURPLE, SKYBLUE, BLUE,
-};
+#include "position.hpp"
 
-class Grid
+// Board of Rows by Cols cells. Each row is one machine word, the smallest of
+// 16, 32 or 64 bits that holds a bit per column, so wide boards get the same
+// bitboard fast paths as the standard one.
+template <int Rows, int Cols>
+class BasicGrid
 {
+  static_assert(Rows > 0 && Rows <= 255, "heights are stored in a byte");
+  static_assert(Cols > 0 && Cols <= 64, "a row has to fit in 64 bits");
+
 public:
-  Grid();
-  std::vector<std::vector<int>> grid;
+  static constexpr int num_rows = Rows;
+  static constexpr int num_cols = Cols;
+
+  // One bit per column, bit n set when column n of the row is occupied
+  using RowMask = std::conditional_t<
+    (Cols <= 16),
+    std::uint16_t,
+    std::conditional_t<(Cols <= 32), std::uint32_t, std::uint64_t>>;
+
+  static constexpr RowMask full_row
+    = Cols == 64 ? ~RowMask(0)
+                 : static_cast<RowMask>((std::uint64_t(1) << Cols) - 1);
+
+  BasicGrid() { initialize(); }
+
+  void initialize()
+  {
+    rows.fill(0);
+    heights.fill(0);
+    hash = 0;
+    for (auto& row : colours)
+    {
+      row.fill(0);
+    }
+  }
+
+  auto isCellOutside(int row, int column) const -> bool
+  {
+    if (row >= 0 && row < num_rows && column >= 0 && column < num_cols)
+    {
+      return false;
+    }
+    return true;
+  }
+
+  auto isCellEmpty(int row, int column) const -> bool
+  {
+    return (rows[row] & bit(column)) == 0;
+  }
+
+  auto getCell(int row, int column) const -> int
+  {
+    return colours[row][column];
+  }
+
+  void setCell(int row, int column, int value)
+  {
+    colours[row][column] = static_cast<std::uint8_t>(value);
+    RowMask before       = rows[row];
+    if (value == 0)
+    {
+      rows[row] &= static_cast<RowMask>(~bit(column));
+    }
+    else
+    {
+      rows[row] |= bit(column);
+    }
+    if (rows[row] == before)
+    {
+      return;
+    }
+    hash ^= zobrist_keys[row][column];
+    if (value != 0 && num_rows - row > heights[column])
+    {
+      heights[column] = static_cast<std::uint8_t>(num_rows - row);
+    }
+    else if (value == 0 && num_rows - row == heights[column])
+    {
+      heights[column] = static_cast<std::uint8_t>(scanHeight(column));
+    }
+  }
+
+  auto rowMask(int row) const -> RowMask { return rows[row]; }
+  // Every row mask, top row first
+  auto rowMasks() const -> const RowMask* { return rows.data(); }
+
+  // Zobrist hash of the occupied cells, kept up to date by every change
+  auto getHash() const -> std::uint64_t { return hash; }
+
+  // Rows from the bottom up to and including the highest filled cell of the
+  // column, kept up to date by every change
+  auto getColumnHeight(int column) const -> int { return heights[column]; }
+
+  // How many rows the cells can fall before landing. Looks at one surface
+  // height per cell, only scanning when a cell is tucked under an overhang.
+  auto dropDistance(const std::array<Position, 4>& cells) const -> int
+  {
+    int  distance = num_rows;
+    bool covered  = false;
+    for (const auto& cell : cells)
+    {
+      // The first filled row of the column, or the floor
+      int surface = num_rows - heights[cell.column];
+      covered |= cell.row >= surface;
+      distance = std::min(distance, surface - 1 - cell.row);
+    }
+    if (!covered)
+    {
+      return distance;
+    }
 
-  void initialize();
-  void random_grid();
-  void print();
-  void draw();
-  auto isCellOutside(int row, int column) -> bool;
-  auto isCellEmpty(int row, int column) -> bool;
-  auto clearFullRoads() -> int;
+    // Under an overhang the surface says nothing, step down until it lands
+    distance = 0;
+    while (true)
+    {
+      for (const auto& cell : cells)
+      {
+        int row = cell.row + distance + 1;
+        if (row >= num_rows || !isCellEmpty(row, cell.column))
+        {
+          return distance;
+        }
+      }
+      distance++;
+    }
+  }
+
+  auto clearFullRoads() -> int
+  {
+    int completed   = 0;
+    int highest_row = num_rows;
+    for (int row = num_rows - 1; row >= 0; --row)
+    {
+      if (isRowFull(row))
+      {
+        clearRow(row);
+        completed++;
+        highest_row = row;
+      }
+      else if (completed > 0 && rows[row] != 0)
+      {
+        moveRowDown(row, completed);
+      }
+    }
+    if (completed == 0)
+    {
+      return 0;
+    }
+
+    // Every cleared row was full, so each column's top was at or above the
+    // highest of them. Tops above it just moved down, tops that were cleared
+    // need a scan for whatever is left underneath.
+    for (int col = 0; col < num_cols; col++)
+    {
+      if (num_rows - heights[col] < highest_row)
+      {
+        heights[col] = static_cast<std::uint8_t>(heights[col] - completed);
+      }
+      else
+      {
+        heights[col] = static_cast<std::uint8_t>(scanHeight(col));
+      }
+    }
+    return completed;
+  }
+
+  // Pushes every row up and fills the bottom lines rows with garbage, full
+  // apart from a hole at hole_column. False when filled cells were pushed
+  // off the top.
+  auto addGarbage(int lines, int hole_column, int colour) -> bool
+  {
+    lines         = std::min(lines, num_rows);
+    bool overflow = false;
+    for (int row = 0; row < lines; row++)
+    {
+      overflow |= rows[row] != 0;
+    }
+    for (int row = 0; row < num_rows - lines; row++)
+    {
+      rows[row]    = rows[row + lines];
+      colours[row] = colours[row + lines];
+    }
+    for (int row = num_rows - lines; row < num_rows; row++)
+    {
+      rows[row] = static_cast<RowMask>(full_row & ~bit(hole_column));
+      colours[row].fill(static_cast<std::uint8_t>(colour));
+      colours[row][hole_column] = 0;
+    }
+
+    // Every row moved, so the hash is rebuilt from scratch
+    hash = 0;
+    for (int row = 0; row < num_rows; row++)
+    {
+      hash ^= rowHash(row, rows[row]);
+    }
+    for (int col = 0; col < num_cols; col++)
+    {
+      if (overflow || (col == hole_column && heights[col] == 0))
+      {
+        heights[col] = static_cast<std::uint8_t>(scanHeight(col));
+      }
+      else
+      {
+        heights[col] = static_cast<std::uint8_t>(heights[col] + lines);
+      }
+    }
+    return !overflow;
+  }
 
 private:
-  static const int num_rows  = 20;
-  static const int num_cols  = 10;
-  static const int cell_size = 30;
+  using ZobristKeys
+    = std::array<std::array<std::uint64_t, num_cols>, num_rows>;
+
+  // One random key per cell from a fixed splitmix64 stream, so hashes are the
+  // same in every build and run
+  static constexpr auto buildZobristKeys() -> ZobristKeys
+  {
+    ZobristKeys   keys  = {};
+    std::uint64_t state = 0x243f6a8885a308d3;
+    for (auto& row : keys)
+    {
+      for (auto& key : row)
+      {
+        std::uint64_t z = (state += 0x9e3779b97f4a7c15);
+        z               = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+        z               = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+        key             = z ^ (z >> 31);
+      }
+    }
+    return keys;
+  }
+
+  static constexpr ZobristKeys zobrist_keys = buildZobristKeys();
+
+  // Occupancy bitboard, all the rules work on this
+  std::array<RowMask, num_rows> rows;
+  // Block id of every cell, only read for drawing
+  std::array<std::array<std::uint8_t, num_cols>, num_rows> colours;
+  std::uint64_t                                            hash;
+  std::array<std::uint8_t, num_cols>                       heights;
 
-  auto isRowFull(int row) -> bool;
-  void clearRow(int row);
-  void moveRowDown(int row, int n);
+  static constexpr auto bit(int column) -> RowMask
+  {
+    return static_cast<RowMask>(RowMask(1) << column);
+  }
+
+  static auto rowHash(int row, RowMask mask) -> std::uint64_t
+  {
+    std::uint64_t result = 0;
+    for (std::uint64_t bits = mask; bits != 0; bits &= bits - 1)
+    {
+      result ^= zobrist_keys[row][std::countr_zero(bits)];
+    }
+    return result;
+  }
+
+  auto scanHeight(int column) const -> int
+  {
+    for (int row = 0; row < num_rows; row++)
+    {
+      if ((rows[row] & bit(column)) != 0)
+      {
+        return num_rows - row;
+      }
+    }
+    return 0;
+  }
+
+  auto isRowFull(int row) const -> bool { return rows[row] == full_row; }
+
+  void clearRow(int row)
+  {
+    hash ^= rowHash(row, rows[row]);
+    rows[row] = 0;
+    colours[row].fill(0);
+  }
+
+  // The row n below is always empty by the time a row is moved onto it
+  void moveRowDown(int row, int n)
+  {
+    rows[row + n]    = rows[row];
+    colours[row + n] = colours[row];
+    hash ^= rowHash(row + n, rows[row]);
+    clearRow(row);
+  }
 };
+
+// The standard 20 by 10 board everything else plays on
+using Grid = BasicGrid<20, 10>;
+
+// Boards with 32 and 64 bit rows, instantiated in grid.cpp so every row width
+// gets compiled. engine.cpp builds the rules on them too.
+extern template class BasicGrid<20, 32>;
+extern template class BasicGrid<20, 64>;
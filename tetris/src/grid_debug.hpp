@@ -0,0 +1,20 @@
+#pragma once
+
+#include "grid.hpp"
+#include <iostream>
+
+// Prints the block id of every cell, a line per row, for poking at boards
+// from a debugger or a scratch test. Kept out of grid.hpp so the engine
+// doesn't pull in iostream.
+template <int Rows, int Cols>
+void printGrid(const BasicGrid<Rows, Cols>& grid)
+{
+  for (int row = 0; row < Rows; row++)
+  {
+    std::cout << "\n";
+    for (int col = 0; col < Cols; col++)
+    {
+      std::cout << grid.getCell(row, col);
+    }
+  }
+}
@@ -1,59 +1,109 @@
 #include "../include/raylib-cpp.hpp"
+#include "fixed_step.hpp"
 #include "game.hpp"
+#include "tuner.hpp"
+#include <algorithm>
+#include <cmath>
+#include <ctime>
 #include <iostream>
+#include <string>
 
-auto event_triggered(double interval, double& last_update_time) -> bool
+// Options:
+//   --seed <n>       play the piece sequence for seed n
+//   --record <file>  save a replay of the session to file on exit
+//   --tick-rate <hz> simulation ticks per second, independent of the frame rate
+//   --stats <file>   write per frame stats to file as CSV (F3 shows them)
+//   --weights <file> autoplay (A) with weights saved by make tune
+auto main(int argc, char** argv) -> int
 {
-  double current_time = GetTime();
-  if (current_time - last_update_time >= interval)
+  auto        seed      = static_cast<std::uint64_t>(std::time(nullptr));
+  double      tick_rate = 120;
+  std::string record_path;
+  std::string stats_path;
+  std::string weights_path;
+  for (int i = 1; i + 1 < argc; i += 2)
   {
-    last_update_time = current_time;
-    return true;
+    std::string option = argv[i];
+    if (option == "--seed")
+    {
+      seed = std::stoull(argv[i + 1]);
+    }
+    else if (option == "--record")
+    {
+      record_path = argv[i + 1];
+    }
+    else if (option == "--tick-rate")
+    {
+      tick_rate = std::stod(argv[i + 1]);
+    }
+    else if (option == "--stats")
+    {
+      stats_path = argv[i + 1];
+    }
+    else if (option == "--weights")
+    {
+      weights_path = argv[i + 1];
+    }
   }
-  return false;
-}
-
-auto main() -> int
-{
-  const int screenWidth  = 500;
-  const int screenHeight = 620;
 
+  // Seconds per gravity step
   const double game_speed = 0.2;
 
-  double last_update_time = 0;
-
-  raylib::Window w(screenWidth, screenHeight, "Tetris");
+  raylib::Window w(Game::screen_width, Game::screen_height, "Tetris");
 
   SetTargetFPS(60);
 
-  auto game = Game();
+  auto gravity_ticks = static_cast<int>(std::lround(game_speed * tick_rate));
+  auto game          = Game(seed, std::max(1, gravity_ticks));
+  auto clock         = tetris::FixedStep(tick_rate);
+
+  if (!stats_path.empty() && !game.stats.openCsv(stats_path))
+  {
+    std::cerr << "Could not open " << stats_path << " for stats\n";
+    return 1;
+  }
+  if (!weights_path.empty())
+  {
+    tetris::Weights weights;
+    if (!tetris::loadWeights(weights_path, weights))
+    {
+      std::cerr << "Could not read weights from " << weights_path << "\n";
+      return 1;
+    }
+    game.setAutoplayWeights(weights);
+  }
 
   // Main game loop
   while (!w.ShouldClose())  // Detect window close button or ESC key
   {
-    // Update
+    // Update. EndDrawing polled input once for the frame, its actions apply
+    // before the ticks the frame catches up on.
+    game.stats.beginFrame();
+    game.stats.beginSim();
+    int ticks = clock.advance(GetTime());
     game.handleInput();
-    if (event_triggered(game_speed, last_update_time))
+    for (int i = 0; i < ticks; i++)
     {
-      game.moveBlockDown();
+      game.tick();
     }
-    
-    auto score_str = std::to_string(game.score);
-  
-    // Draw
+    game.stats.endSim();
+
+    // Draw. Only the time spent building the frame counts, EndDrawing waits
+    // for the frame rate cap.
+    game.stats.beginDraw();
+    game.refreshCache();
     BeginDrawing();
-    ClearBackground(DARKGRAY);
-    DrawRectangleRounded({ 320, 55, 170, 60 }, 0.3, 6, GRAY);
-    DrawRectangleRounded({ 320, 250, 170, 180 }, 0.3, 6, GRAY);
-    raylib::DrawText("Score", 365, 15, 38, RAYWHITE);
-    raylib::DrawText(score_str.c_str(), 333, 65, 38, RAYWHITE);
-    raylib::DrawText("Next", 370, 175, 38, RAYWHITE);
-    if (game.game_over)
-    {
-      raylib::DrawText("GAME OVER", 320, 450, 38, RAYWHITE);
-    }
-    game.draw();
+    game.draw(clock.alpha());
+    game.stats.countBatch();
+    game.stats.endDraw();
     EndDrawing();
+    game.stats.endFrame();
+  }
+
+  if (!record_path.empty() && !game.replay.save(record_path))
+  {
+    std::cerr << "Could not write replay to " << record_path << "\n";
+    return 1;
   }
   return 0;
 }
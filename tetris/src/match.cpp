@@ -0,0 +1,305 @@
+#include "match.hpp"
+#include <algorithm>
+#include <limits>
+
+namespace tetris
+{
+
+static_assert(max_players == 4, "Match spells out one engine per player");
+
+static const std::uint32_t no_rollback
+  = std::numeric_limits<std::uint32_t>::max();
+
+auto garbageForLines(int lines_cleared) -> int
+{
+  switch (lines_cleared)
+  {
+    case 2:
+      return 1;
+    case 3:
+      return 2;
+    case 4:
+      return 4;
+    default:
+      return 0;
+  }
+}
+
+Match::Match(int num_players, std::uint64_t seed, int gravity_frames)
+: engines { { Engine(seed), Engine(seed), Engine(seed), Engine(seed) } }
+, frame(0)
+, seed(seed)
+, num_players(std::clamp(num_players, 1, max_players))
+, gravity_frames(gravity_frames)
+{
+  gravity_counters.fill(0);
+  garbage_sent.fill(0);
+}
+
+void Match::step(const Input* inputs)
+{
+  std::array<int, max_players> cleared = {};
+  for (int i = 0; i < num_players; i++)
+  {
+    Engine& engine = engines[i];
+    if (engine.game_over)
+    {
+      continue;
+    }
+    int lines = engine.lines;
+    if (inputs[i] != no_input && inputs[i] <= toInput(Action::HardDrop))
+    {
+      engine.step(static_cast<Action>(inputs[i] - 1));
+    }
+    if (++gravity_counters[i] >= gravity_frames)
+    {
+      gravity_counters[i] = 0;
+      engine.step(Action::Down);
+    }
+    cleared[i] = engine.lines - lines;
+  }
+
+  // Garbage goes out once everyone has moved this frame
+  for (int i = 0; i < num_players; i++)
+  {
+    int garbage = garbageForLines(cleared[i]);
+    for (int next = 1; garbage > 0 && next < num_players; next++)
+    {
+      Engine& target = engines[(i + next) % num_players];
+      if (!target.game_over)
+      {
+        target.addGarbage(garbage, holeColumn(i));
+        break;
+      }
+    }
+  }
+  frame++;
+}
+
+auto Match::save() const -> MatchState
+{
+  MatchState state;
+  for (int i = 0; i < max_players; i++)
+  {
+    state.players[i] = engines[i].save();
+  }
+  state.gravity_counters = gravity_counters;
+  state.garbage_sent     = garbage_sent;
+  state.frame            = frame;
+  return state;
+}
+
+void Match::restore(const MatchState& state)
+{
+  for (int i = 0; i < max_players; i++)
+  {
+    engines[i].restore(state.players[i]);
+  }
+  gravity_counters = state.gravity_counters;
+  garbage_sent     = state.garbage_sent;
+  frame            = state.frame;
+}
+
+auto Match::getNumPlayers() const -> int { return num_players; }
+
+auto Match::getFrame() const -> std::uint32_t { return frame; }
+
+auto Match::getEngine(int player) const -> const Engine&
+{
+  return engines[player];
+}
+
+auto Match::isOver() const -> bool
+{
+  int standing = 0;
+  for (int i = 0; i < num_players; i++)
+  {
+    standing += !engines[i].game_over;
+  }
+  return standing <= 1;
+}
+
+auto Match::getChecksum() const -> std::uint64_t
+{
+  std::uint64_t checksum = frame;
+  for (int i = 0; i < num_players; i++)
+  {
+    const Engine& engine = engines[i];
+    const Block&  block  = engine.getCurrentBlock();
+    for (std::uint64_t value : {
+           engine.grid.getHash(),
+           static_cast<std::uint64_t>(engine.score),
+           static_cast<std::uint64_t>(engine.game_over),
+           static_cast<std::uint64_t>(block.id),
+           static_cast<std::uint64_t>(block.getRotation()),
+           static_cast<std::uint64_t>(block.getRowOffset()),
+           static_cast<std::uint64_t>(block.getColOffset()),
+         })
+    {
+      checksum = (checksum ^ value) * 0x100000001b3;
+    }
+  }
+  return checksum;
+}
+
+// splitmix64 of the seed, the sender and how much it has sent, so holes
+// line up on every peer however the frames were simulated
+auto Match::holeColumn(int player) -> int
+{
+  std::uint64_t z = seed ^ (static_cast<std::uint64_t>(player) << 56)
+                    ^ garbage_sent[player]++;
+  z = (z + 0x9e3779b97f4a7c15);
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+  z = z ^ (z >> 31);
+  return static_cast<int>(z % Grid::num_cols);
+}
+
+LoopbackTransport::LoopbackTransport(int num_peers, int latency_frames)
+: queues(num_peers)
+, now(0)
+, latency_frames(latency_frames)
+{
+}
+
+void LoopbackTransport::send(int from, const InputMessage& message)
+{
+  auto arrival = now + static_cast<std::uint32_t>(latency_frames);
+  for (int peer = 0; peer < static_cast<int>(queues.size()); peer++)
+  {
+    if (peer != from)
+    {
+      queues[peer].push_back({ arrival, message });
+    }
+  }
+}
+
+auto LoopbackTransport::receive(int peer, InputMessage& message) -> bool
+{
+  auto& queue = queues[peer];
+  if (queue.empty() || queue.front().arrival > now)
+  {
+    return false;
+  }
+  message = queue.front().message;
+  queue.pop_front();
+  return true;
+}
+
+void LoopbackTransport::tick() { now++; }
+
+RollbackPeer::RollbackPeer(int           local_player,
+                           int           num_players,
+                           std::uint64_t seed,
+                           int           gravity_frames,
+                           int           input_delay)
+: match(num_players, seed, gravity_frames)
+, rollback_frame(no_rollback)
+, local_player(local_player)
+, input_delay(std::clamp(input_delay, 0, max_input_delay))
+, rollbacks(0)
+, resimulated_frames(0)
+{
+  for (auto& inputs : frames)
+  {
+    inputs.frame = no_rollback;
+  }
+  // Nobody sends input for the frames before the delay kicks in
+  next_remote.fill(static_cast<std::uint32_t>(this->input_delay));
+}
+
+auto RollbackPeer::slot(std::uint32_t frame) -> FrameInputs&
+{
+  FrameInputs& inputs = frames[frame % history];
+  if (inputs.frame != frame)
+  {
+    inputs.frame = frame;
+    inputs.inputs.fill(no_input);
+    inputs.known.fill(frame < static_cast<std::uint32_t>(input_delay));
+  }
+  return inputs;
+}
+
+void RollbackPeer::addRemoteInput(const InputMessage& message)
+{
+  int          player = message.player;
+  FrameInputs& inputs = slot(message.frame);
+  // Frames already played used the prediction, a different input means
+  // they have to be played again
+  if (message.frame < match.getFrame()
+      && inputs.inputs[player] != message.input)
+  {
+    rollback_frame = std::min(rollback_frame, message.frame);
+  }
+  inputs.inputs[player] = message.input;
+  inputs.known[player]  = true;
+  while (slot(next_remote[player]).known[player])
+  {
+    next_remote[player]++;
+  }
+}
+
+auto RollbackPeer::advance(Input local_input, InputMessage& message) -> bool
+{
+  rollback();
+  if (match.getFrame() >= std::uint64_t(getConfirmedFrame()) + max_rollback)
+  {
+    return false;
+  }
+
+  auto         frame  = match.getFrame() + input_delay;
+  FrameInputs& inputs = slot(frame);
+  inputs.inputs[local_player] = local_input;
+  inputs.known[local_player]  = true;
+
+  message = { frame, static_cast<std::uint8_t>(local_player), local_input };
+  simulateFrame();
+  return true;
+}
+
+void RollbackPeer::rollback()
+{
+  auto target = match.getFrame();
+  if (rollback_frame < target)
+  {
+    match.restore(states[rollback_frame % history]);
+    rollbacks++;
+    while (match.getFrame() < target)
+    {
+      simulateFrame();
+      resimulated_frames++;
+    }
+  }
+  rollback_frame = no_rollback;
+}
+
+void RollbackPeer::simulateFrame()
+{
+  auto frame              = match.getFrame();
+  states[frame % history] = match.save();
+  match.step(slot(frame).inputs.data());
+}
+
+auto RollbackPeer::getMatch() const -> const Match& { return match; }
+
+auto RollbackPeer::getConfirmedFrame() const -> std::uint32_t
+{
+  auto confirmed = no_rollback;
+  for (int player = 0; player < match.getNumPlayers(); player++)
+  {
+    if (player != local_player)
+    {
+      confirmed = std::min(confirmed, next_remote[player]);
+    }
+  }
+  return confirmed;
+}
+
+auto RollbackPeer::getRollbacks() const -> long { return rollbacks; }
+
+auto RollbackPeer::getResimulatedFrames() const -> long
+{
+  return resimulated_frames;
+}
+
+}  // namespace tetris
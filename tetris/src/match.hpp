@@ -0,0 +1,165 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+#include "engine.hpp"
+
+namespace tetris
+{
+
+// Garbage rows sent to the opponent for clearing this many rows at once
+auto garbageForLines(int lines_cleared) -> int;
+
+// One player's input for one frame: nothing, or 1 + an Action
+using Input = std::uint8_t;
+
+static const Input no_input = 0;
+
+inline auto toInput(Action action) -> Input
+{
+  return static_cast<Input>(static_cast<int>(action) + 1);
+}
+
+static const int max_players = 4;
+
+// A whole match as one flat value, what rollback saves every frame
+struct MatchState
+{
+  std::array<GameState, max_players>     players;
+  std::array<std::int32_t, max_players>  gravity_counters;
+  std::array<std::uint32_t, max_players> garbage_sent;
+  std::uint32_t                          frame;
+};
+
+// Two to four engines played in lock step. Every player gets the same piece
+// sequence. Rows cleared in a frame turn into garbage for the next player
+// still in the game, each garbage batch with its hole in a column picked
+// from the seed, so the same inputs always play out the same match.
+class Match
+{
+public:
+  Match(int num_players, std::uint64_t seed, int gravity_frames);
+
+  // Runs one frame, inputs[i] is player i's input for it. Resets are
+  // ignored, a player who tops out stays out.
+  void step(const Input* inputs);
+  auto save() const -> MatchState;
+  void restore(const MatchState& state);
+
+  auto getNumPlayers() const -> int;
+  auto getFrame() const -> std::uint32_t;
+  auto getEngine(int player) const -> const Engine&;
+  // At most one player left standing
+  auto isOver() const -> bool;
+  // Hash of every board, block and score, for spotting desyncs
+  auto getChecksum() const -> std::uint64_t;
+
+private:
+  auto holeColumn(int player) -> int;
+
+  std::array<Engine, max_players>        engines;
+  std::array<std::int32_t, max_players>  gravity_counters;
+  std::array<std::uint32_t, max_players> garbage_sent;
+  std::uint32_t                          frame;
+  std::uint64_t                          seed;
+  int                                    num_players;
+  int                                    gravity_frames;
+};
+
+struct InputMessage
+{
+  std::uint32_t frame;
+  std::uint8_t  player;
+  Input         input;
+};
+
+// Stands in for the network in tests: every message reaches every other
+// peer a fixed number of frames after it was sent, in order
+class LoopbackTransport
+{
+public:
+  LoopbackTransport(int num_peers, int latency_frames);
+
+  void send(int from, const InputMessage& message);
+  // Next message that has arrived for the peer, false when there is none
+  auto receive(int peer, InputMessage& message) -> bool;
+  // Moves the transport's clock on one frame
+  void tick();
+
+private:
+  struct Packet
+  {
+    std::uint32_t arrival;
+    InputMessage  message;
+  };
+
+  std::vector<std::deque<Packet>> queues;
+  std::uint32_t                   now;
+  int                             latency_frames;
+};
+
+// One peer of a match with delay based and rollback netcode. Local input is
+// scheduled input_delay frames ahead, which hides that much latency
+// outright. Remote inputs that haven't arrived yet are predicted as no
+// input. When a late one turns out different, the match is rewound to the
+// saved state of that frame and played forward again with the real inputs.
+//
+// Every peer has to use the same seed, gravity and input delay.
+class RollbackPeer
+{
+public:
+  // Frames the simulation may run ahead of the last fully known frame
+  static const int max_rollback    = 8;
+  static const int max_input_delay = 16;
+
+  RollbackPeer(int           local_player,
+               int           num_players,
+               std::uint64_t seed,
+               int           gravity_frames,
+               int           input_delay);
+
+  void addRemoteInput(const InputMessage& message);
+  // Schedules the local input, fixes up any misprediction and simulates one
+  // frame. message is what has to be sent to the other peers. False, with
+  // nothing done, while too far ahead of the remote inputs.
+  auto advance(Input local_input, InputMessage& message) -> bool;
+  // Replays from the earliest misprediction if there is one. advance does
+  // this first anyway.
+  void rollback();
+
+  auto getMatch() const -> const Match&;
+  // Every input before this frame is known
+  auto getConfirmedFrame() const -> std::uint32_t;
+  auto getRollbacks() const -> long;
+  auto getResimulatedFrames() const -> long;
+
+private:
+  // Frames of inputs and states kept. Has to cover the rollback window and
+  // the input delay of both ends, so the delay is capped at max_input_delay.
+  static const std::uint32_t history = 64;
+
+  struct FrameInputs
+  {
+    std::uint32_t                  frame;
+    std::array<Input, max_players> inputs;
+    std::array<bool, max_players>  known;
+  };
+
+  auto slot(std::uint32_t frame) -> FrameInputs&;
+  void simulateFrame();
+
+  Match                                  match;
+  std::array<FrameInputs, history>       frames;
+  std::array<MatchState, history>        states;
+  std::array<std::uint32_t, max_players> next_remote;
+  std::uint32_t                          rollback_frame;
+  int                                    local_player;
+  int                                    input_delay;
+  long                                   rollbacks;
+  long                                   resimulated_frames;
+};
+
+}  // namespace tetris
@@ -1,7 +0,0 @@
-#include "position.hpp"
-
-Position::Position(int row, int column)
-: row(row)
-, column(column)
-{
-}
\ No newline at end of file
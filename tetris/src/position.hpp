@@ -5,5 +5,12 @@ class Position
 public:
   int row{};
   int column{};
-  Position(int row, int column);
+
+  constexpr Position() = default;
+
+  constexpr Position(int row, int column)
+  : row(row)
+  , column(column)
+  {
+  }
 };
@@ -0,0 +1,42 @@
+#include "randomizer.hpp"
+
+namespace tetris
+{
+
+BagRandomizer::BagRandomizer(std::uint64_t seed) { this->seed(seed); }
+
+void BagRandomizer::seed(std::uint64_t seed)
+{
+  state     = seed;
+  remaining = 0;
+  bag.fill(0);
+}
+
+// splitmix64, one 64 bit word of state and good enough mixing for shuffling
+auto BagRandomizer::nextRandom() -> std::uint64_t
+{
+  std::uint64_t z = (state += 0x9e3779b97f4a7c15);
+  z               = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+  z               = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+  return z ^ (z >> 31);
+}
+
+auto BagRandomizer::next() -> int
+{
+  if (remaining == 0)
+  {
+    for (int i = 0; i < 7; i++)
+    {
+      bag[i] = static_cast<std::uint8_t>(i + 1);
+    }
+    remaining = 7;
+  }
+  // Take a random piece out of the bag and fill its slot with the last one
+  auto index = static_cast<int>(nextRandom() % remaining);
+  int  id    = bag[index];
+  bag[index] = bag[remaining - 1];
+  remaining--;
+  return id;
+}
+
+}  // namespace tetris
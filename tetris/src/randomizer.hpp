@@ -0,0 +1,29 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+namespace tetris
+{
+
+// 7-bag piece generator: every run of seven pieces holds each block once, in
+// an order shuffled by a small seeded PRNG. The whole state is a few bytes, so
+// copying an engine copies its future piece sequence with it.
+class BagRandomizer
+{
+public:
+  explicit BagRandomizer(std::uint64_t seed = 0);
+
+  void seed(std::uint64_t seed);
+  // Block id of the next piece, 1 to 7
+  auto next() -> int;
+
+private:
+  auto nextRandom() -> std::uint64_t;
+
+  std::uint64_t               state;
+  std::array<std::uint8_t, 7> bag;
+  int                         remaining;
+};
+
+}  // namespace tetris
@@ -0,0 +1,132 @@
+#include "records.hpp"
+#include <cstring>
+
+namespace tetris
+{
+
+static const char          record_magic[8] = { 'T', 'E', 'T', 'R',
+                                               'S', 'P', 'O', 'S' };
+static const std::uint32_t record_version  = 1;
+
+static auto makeHeader(std::uint64_t num_records) -> RecordFileHeader
+{
+  RecordFileHeader header = {};
+  std::memcpy(header.magic, record_magic, sizeof(record_magic));
+  header.version     = record_version;
+  header.record_size = sizeof(PositionRecord);
+  header.num_records = num_records;
+  header.num_rows    = Grid::num_rows;
+  header.num_cols    = Grid::num_cols;
+  return header;
+}
+
+auto playSelfPlayGame(std::uint64_t   seed,
+                      GreedyPlayer&   player,
+                      int             max_pieces,
+                      PositionRecord* out) -> int
+{
+  Engine engine(seed);
+  int    count = 0;
+  while (!engine.game_over && count < max_pieces)
+  {
+    const Block& block  = engine.getCurrentBlock();
+    int          choice = player.choose(engine.grid, block);
+    if (choice < 0)
+    {
+      break;
+    }
+    const Placement& placement = player.getMoves().getPlacement(choice);
+
+    PositionRecord& record = out[count++];
+    for (int row = 0; row < Grid::num_rows; row++)
+    {
+      record.rows[row] = engine.grid.rowMask(row);
+    }
+    record.piece      = static_cast<std::uint8_t>(block.id);
+    record.next_piece = static_cast<std::uint8_t>(engine.getNextBlock().id);
+    record.rotation   = static_cast<std::uint8_t>(placement.rotation);
+    record.row_offset = static_cast<std::int8_t>(placement.row_offset);
+    record.col_offset = static_cast<std::int8_t>(placement.col_offset);
+    record.reserved   = 0;
+    record.seed       = seed;
+
+    int lines = engine.lines;
+    engine.place(player.getMoves().getBlock(choice));
+    record.lines_cleared = static_cast<std::uint8_t>(engine.lines - lines);
+  }
+
+  // The outcome is only known now, filled in back to front
+  bool          topped_out = count < max_pieces || engine.game_over;
+  std::uint32_t lines_left = 0;
+  for (int i = count - 1; i >= 0; i--)
+  {
+    lines_left += out[i].lines_cleared;
+    out[i].topped_out  = topped_out;
+    out[i].pieces_left = static_cast<std::uint32_t>(count - i);
+    out[i].lines_left  = lines_left;
+  }
+  return count;
+}
+
+RecordWriter::RecordWriter()
+: count(0)
+{
+}
+
+RecordWriter::~RecordWriter()
+{
+  if (file.is_open())
+  {
+    close();
+  }
+}
+
+auto RecordWriter::open(const std::string& path) -> bool
+{
+  file.open(path, std::ios::binary | std::ios::trunc);
+  count = 0;
+  // Written again with the final count on close
+  auto header = makeHeader(0);
+  file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  return file.good();
+}
+
+void RecordWriter::write(const PositionRecord* records, int count)
+{
+  file.write(reinterpret_cast<const char*>(records),
+             static_cast<std::streamsize>(count * sizeof(PositionRecord)));
+  this->count += static_cast<std::uint64_t>(count);
+}
+
+auto RecordWriter::close() -> bool
+{
+  auto header = makeHeader(count);
+  file.seekp(0);
+  file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  bool good = file.good();
+  file.close();
+  return good;
+}
+
+auto RecordWriter::getCount() const -> std::uint64_t { return count; }
+
+auto readRecordCount(const std::string& path) -> std::int64_t
+{
+  std::ifstream    file(path, std::ios::binary | std::ios::ate);
+  RecordFileHeader header = {};
+  auto             size   = static_cast<std::uint64_t>(file.tellg());
+  file.seekg(0);
+  if (!file.read(reinterpret_cast<char*>(&header), sizeof(header))
+      || std::memcmp(header.magic, record_magic, sizeof(record_magic)) != 0
+      || header.version != record_version
+      || header.record_size != sizeof(PositionRecord)
+      || header.num_rows != Grid::num_rows
+      || header.num_cols != Grid::num_cols
+      || size != sizeof(header) + header.num_records * sizeof(PositionRecord))
+  {
+    return -1;
+  }
+  return static_cast<std::int64_t>(header.num_records);
+}
+
+}  // namespace tetris
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <type_traits>
+
+#include "ai.hpp"
+#include "grid.hpp"
+
+namespace tetris
+{
+
+// One position from a self-play game: the board and pieces the player saw,
+// the placement it picked and how the rest of its game went. Fixed size with
+// no pointers, so a file of them can be mapped and read in place.
+struct PositionRecord
+{
+  std::array<Grid::RowMask, Grid::num_rows> rows;
+  std::uint8_t                              piece;
+  std::uint8_t                              next_piece;
+  // The placement, in Block's terms
+  std::uint8_t                              rotation;
+  std::int8_t                               row_offset;
+  std::int8_t                               col_offset;
+  // Rows this placement cleared
+  std::uint8_t                              lines_cleared;
+  // Whether the game ended by topping out rather than hitting the piece cap
+  std::uint8_t                              topped_out;
+  std::uint8_t                              reserved;
+  // Placements from this one to the end of the game, this one included
+  std::uint32_t                             pieces_left;
+  // Rows cleared from this placement to the end of the game
+  std::uint32_t                             lines_left;
+  std::uint64_t                             seed;
+};
+
+static_assert(sizeof(PositionRecord) == 64, "records are one cache line");
+static_assert(std::is_trivially_copyable_v<PositionRecord>);
+
+// Start of every record file, padded so the records after it stay 64 byte
+// aligned. Everything is stored in native byte order, little endian on every
+// platform the game builds for.
+struct RecordFileHeader
+{
+  char          magic[8];
+  std::uint32_t version;
+  std::uint32_t record_size;
+  std::uint64_t num_records;
+  std::uint8_t  num_rows;
+  std::uint8_t  num_cols;
+  std::uint8_t  padding[38];
+};
+
+static_assert(sizeof(RecordFileHeader) == 64);
+
+// Plays one game from seed with the player, a placement per record, until
+// it tops out or has placed max_pieces blocks. Records are written straight
+// into out, which needs room for max_pieces of them. Returns how many.
+auto playSelfPlayGame(std::uint64_t   seed,
+                      GreedyPlayer&   player,
+                      int             max_pieces,
+                      PositionRecord* out) -> int;
+
+// Streams records into one file. Not thread safe on purpose: every thread
+// writes its own file, so nothing is shared and nothing is locked.
+class RecordWriter
+{
+public:
+  RecordWriter();
+  ~RecordWriter();
+
+  auto open(const std::string& path) -> bool;
+  // Writes the records as they are in memory, no conversion
+  void write(const PositionRecord* records, int count);
+  // Fills the record count into the header, false when any write failed
+  auto close() -> bool;
+  auto getCount() const -> std::uint64_t;
+
+private:
+  std::ofstream file;
+  std::uint64_t count;
+};
+
+// Checks the header of a record file and returns how many records follow it,
+// -1 when it isn't one
+auto readRecordCount(const std::string& path) -> std::int64_t;
+
+}  // namespace tetris
@@ -0,0 +1,157 @@
+#include "replay.hpp"
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+
+namespace tetris
+{
+
+static const char         magic[4]    = { 'T', 'R', 'P', 'L' };
+static const std::uint8_t version     = 1;
+static const int          action_bits = 3;
+
+static void putInt(std::vector<std::uint8_t>& out,
+                   std::uint64_t              value,
+                   int                        bytes)
+{
+  for (int i = 0; i < bytes; i++)
+  {
+    out.push_back(static_cast<std::uint8_t>(value >> (8 * i)));
+  }
+}
+
+static auto getInt(const std::vector<std::uint8_t>& in,
+                   std::size_t&                     pos,
+                   int                              bytes,
+                   std::uint64_t&                   value) -> bool
+{
+  if (pos + bytes > in.size())
+  {
+    return false;
+  }
+  value = 0;
+  for (int i = 0; i < bytes; i++)
+  {
+    value |= static_cast<std::uint64_t>(in[pos++]) << (8 * i);
+  }
+  return true;
+}
+
+static void putVarint(std::vector<std::uint8_t>& out, std::uint64_t value)
+{
+  while (value >= 0x80)
+  {
+    out.push_back(static_cast<std::uint8_t>(value | 0x80));
+    value >>= 7;
+  }
+  out.push_back(static_cast<std::uint8_t>(value));
+}
+
+static auto getVarint(const std::vector<std::uint8_t>& in,
+                      std::size_t&                     pos,
+                      std::uint64_t&                   value) -> bool
+{
+  value = 0;
+  for (int shift = 0; shift < 64 && pos < in.size(); shift += 7)
+  {
+    std::uint8_t byte = in[pos++];
+    value |= static_cast<std::uint64_t>(byte & 0x7f) << shift;
+    if ((byte & 0x80) == 0)
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+Replay::Replay(std::uint64_t seed)
+: seed(seed)
+{
+}
+
+void Replay::record(std::uint32_t frame, Action action)
+{
+  events.push_back({ frame, action });
+}
+
+auto Replay::save(const std::string& path) const -> bool
+{
+  std::vector<std::uint8_t> out(std::begin(magic), std::end(magic));
+  out.push_back(version);
+  putInt(out, seed, 8);
+  putInt(out, events.size(), 4);
+
+  std::uint32_t last_frame = 0;
+  for (const auto& event : events)
+  {
+    std::uint64_t delta = event.frame - last_frame;
+    putVarint(out,
+              delta << action_bits | static_cast<std::uint64_t>(event.action));
+    last_frame = event.frame;
+  }
+
+  std::ofstream file(path, std::ios::binary);
+  file.write(reinterpret_cast<const char*>(out.data()),
+             static_cast<std::streamsize>(out.size()));
+  return file.good();
+}
+
+auto Replay::load(const std::string& path) -> bool
+{
+  std::ifstream file(path, std::ios::binary);
+  if (!file)
+  {
+    return false;
+  }
+  std::vector<std::uint8_t> in((std::istreambuf_iterator<char>(file)),
+                               std::istreambuf_iterator<char>());
+
+  std::size_t pos = sizeof(magic) + 1;
+  if (in.size() < pos
+      || !std::equal(std::begin(magic), std::end(magic), in.begin())
+      || in[sizeof(magic)] != version)
+  {
+    return false;
+  }
+
+  std::uint64_t file_seed = 0;
+  std::uint64_t count     = 0;
+  if (!getInt(in, pos, 8, file_seed) || !getInt(in, pos, 4, count))
+  {
+    return false;
+  }
+
+  std::vector<ReplayEvent> file_events;
+  std::uint32_t            frame = 0;
+  for (std::uint64_t i = 0; i < count; i++)
+  {
+    std::uint64_t packed = 0;
+    if (!getVarint(in, pos, packed))
+    {
+      return false;
+    }
+    auto action = packed & ((1u << action_bits) - 1);
+    if (action > static_cast<std::uint64_t>(Action::Reset))
+    {
+      return false;
+    }
+    frame += static_cast<std::uint32_t>(packed >> action_bits);
+    file_events.push_back({ frame, static_cast<Action>(action) });
+  }
+
+  seed   = file_seed;
+  events = std::move(file_events);
+  return true;
+}
+
+auto Replay::simulate() const -> Engine
+{
+  Engine engine(seed);
+  for (const auto& event : events)
+  {
+    engine.step(event.action);
+  }
+  return engine;
+}
+
+}  // namespace tetris
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "engine.hpp"
+
+namespace tetris
+{
+
+struct ReplayEvent
+{
+  std::uint32_t frame;
+  Action        action;
+};
+
+// Seed plus every action a game was fed. Since the engine is deterministic
+// that is all it takes to play the game again exactly, as fast as the CPU
+// allows.
+//
+// On disk: "TRPL", a version byte, the seed and event count as little endian
+// u64/u32, then one LEB128 varint per event holding the frame delta shifted
+// up three bits with the action in the low bits. Most events take one or two
+// bytes.
+class Replay
+{
+public:
+  std::uint64_t            seed;
+  std::vector<ReplayEvent> events;
+
+  explicit Replay(std::uint64_t seed = 0);
+
+  void record(std::uint32_t frame, Action action);
+  auto save(const std::string& path) const -> bool;
+  auto load(const std::string& path) -> bool;
+  // Runs every event through a fresh engine and returns it
+  auto simulate() const -> Engine;
+};
+
+}  // namespace tetris
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+
+namespace tetris
+{
+
+// Fixed capacity stack that forgets its oldest entry when full. Storage is
+// inline, so pushing and popping never allocate.
+template <typename T, std::size_t Capacity>
+class RingBuffer
+{
+public:
+  void push(const T& value)
+  {
+    items[(first + count) % Capacity] = value;
+    if (count == Capacity)
+    {
+      first = (first + 1) % Capacity;
+    }
+    else
+    {
+      count++;
+    }
+  }
+
+  // Removes the newest entry, false when empty
+  auto pop(T& value) -> bool
+  {
+    if (count == 0)
+    {
+      return false;
+    }
+    count--;
+    value = items[(first + count) % Capacity];
+    return true;
+  }
+
+  // age 0 is the newest entry, size() - 1 the oldest
+  auto at(std::size_t age) const -> const T&
+  {
+    return items[(first + count - 1 - age) % Capacity];
+  }
+
+  auto size() const -> std::size_t { return count; }
+  auto empty() const -> bool { return count == 0; }
+  void clear() { first = count = 0; }
+
+private:
+  std::array<T, Capacity> items;
+  std::size_t             first = 0;
+  std::size_t             count = 0;
+};
+
+}  // namespace tetris
@@ -0,0 +1,227 @@
+#include "session_server.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <chrono>
+
+namespace tetris
+{
+
+LatencyHistogram::LatencyHistogram() { clear(); }
+
+void LatencyHistogram::record(std::uint64_t nanoseconds)
+{
+  int bucket = nanoseconds == 0 ? 0 : std::bit_width(nanoseconds) - 1;
+  if (bucket >= num_buckets)
+  {
+    bucket = num_buckets - 1;
+  }
+  buckets[bucket]++;
+  count++;
+}
+
+void LatencyHistogram::merge(const LatencyHistogram& other)
+{
+  for (int i = 0; i < num_buckets; i++)
+  {
+    buckets[i] += other.buckets[i];
+  }
+  count += other.count;
+}
+
+void LatencyHistogram::clear()
+{
+  buckets.fill(0);
+  count = 0;
+}
+
+auto LatencyHistogram::getCount() const -> std::uint64_t { return count; }
+
+auto LatencyHistogram::percentile(double fraction) const -> std::uint64_t
+{
+  auto          wanted = static_cast<std::uint64_t>(fraction * count);
+  std::uint64_t seen   = 0;
+  for (int i = 0; i < num_buckets; i++)
+  {
+    seen += buckets[i];
+    if (seen > wanted || seen == count)
+    {
+      return std::uint64_t(2) << i;
+    }
+  }
+  return std::uint64_t(2) << (num_buckets - 1);
+}
+
+InputQueue::InputQueue()
+: head(0)
+, tail(0)
+{
+}
+
+auto InputQueue::push(Action action, std::uint64_t time) -> bool
+{
+  auto back  = tail.load(std::memory_order_relaxed);
+  auto front = head.load(std::memory_order_acquire);
+  if (back - front == capacity)
+  {
+    return false;
+  }
+  times[back % capacity]   = time;
+  actions[back % capacity] = action;
+  tail.store(back + 1, std::memory_order_release);
+  return true;
+}
+
+auto InputQueue::pop(Action& action, std::uint64_t& time) -> bool
+{
+  auto front = head.load(std::memory_order_relaxed);
+  auto back  = tail.load(std::memory_order_acquire);
+  if (front == back)
+  {
+    return false;
+  }
+  time   = times[front % capacity];
+  action = actions[front % capacity];
+  head.store(front + 1, std::memory_order_release);
+  return true;
+}
+
+void InputQueue::clear()
+{
+  head.store(0, std::memory_order_relaxed);
+  tail.store(0, std::memory_order_relaxed);
+}
+
+SessionServer::SessionServer(ThreadPool& pool,
+                             int         max_sessions,
+                             int         gravity_ticks,
+                             int         batch_size)
+: pool(pool)
+, sessions(new Session[max_sessions])
+, max_sessions(max_sessions)
+, gravity_ticks(gravity_ticks)
+, batch_size(batch_size)
+, active_count(0)
+, ticks(0)
+, rejected(0)
+{
+  // Hand out low ids first so open sessions stay packed at the front
+  free_ids.reserve(max_sessions);
+  for (int id = max_sessions - 1; id >= 0; id--)
+  {
+    free_ids.push_back(id);
+  }
+}
+
+auto SessionServer::open(std::uint64_t seed) -> int
+{
+  if (free_ids.empty())
+  {
+    return -1;
+  }
+  int id = free_ids.back();
+  free_ids.pop_back();
+
+  Session& session        = sessions[id];
+  session.engine          = Engine(seed);
+  session.gravity_counter = 0;
+  session.inputs.clear();
+  session.latency.clear();
+  session.active.store(true, std::memory_order_release);
+  active_count++;
+  return id;
+}
+
+void SessionServer::close(int id)
+{
+  if (!isOpen(id))
+  {
+    return;
+  }
+  sessions[id].active.store(false, std::memory_order_release);
+  free_ids.push_back(id);
+  active_count--;
+}
+
+auto SessionServer::send(int id, Action action) -> bool
+{
+  if (!isOpen(id) || !sessions[id].inputs.push(action, now()))
+  {
+    rejected.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+  return true;
+}
+
+void SessionServer::tick()
+{
+  int num_batches = (max_sessions + batch_size - 1) / batch_size;
+  pool.parallelFor(num_batches, [this](int batch) {
+    // One clock read per batch, latency is only wanted to bucket precision
+    auto time  = now();
+    int  first = batch * batch_size;
+    int  last  = std::min(first + batch_size, max_sessions);
+    for (int id = first; id < last; id++)
+    {
+      if (sessions[id].active.load(std::memory_order_relaxed))
+      {
+        tickSession(sessions[id], time);
+      }
+    }
+  });
+  ticks++;
+}
+
+void SessionServer::tickSession(Session& session, std::uint64_t time)
+{
+  Action        action;
+  std::uint64_t sent;
+  for (int i = 0; i < max_inputs_per_tick && session.inputs.pop(action, sent);
+       i++)
+  {
+    session.engine.step(action);
+    session.latency.record(time > sent ? time - sent : 0);
+  }
+
+  if (++session.gravity_counter >= gravity_ticks)
+  {
+    session.gravity_counter = 0;
+    session.engine.step(Action::Down);
+  }
+}
+
+auto SessionServer::isOpen(int id) const -> bool
+{
+  return id >= 0 && id < max_sessions
+      && sessions[id].active.load(std::memory_order_acquire);
+}
+
+auto SessionServer::getEngine(int id) const -> const Engine&
+{
+  return sessions[id].engine;
+}
+
+auto SessionServer::getLatency(int id) const -> const LatencyHistogram&
+{
+  return sessions[id].latency;
+}
+
+auto SessionServer::getActiveCount() const -> int { return active_count; }
+
+auto SessionServer::getMaxSessions() const -> int { return max_sessions; }
+
+auto SessionServer::getRejected() const -> std::uint64_t
+{
+  return rejected.load(std::memory_order_relaxed);
+}
+
+auto SessionServer::getTicks() const -> std::uint64_t { return ticks; }
+
+auto SessionServer::now() -> std::uint64_t
+{
+  using namespace std::chrono;
+  return duration_cast<nanoseconds>(steady_clock::now().time_since_epoch())
+    .count();
+}
+
+}  // namespace tetris
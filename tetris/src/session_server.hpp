@@ -0,0 +1,120 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "engine.hpp"
+#include "thread_pool.hpp"
+
+namespace tetris
+{
+
+// Latency histogram with power of two buckets, bucket n counts samples in
+// [2^n, 2^(n+1)) nanoseconds. Fixed size so every session can keep one.
+class LatencyHistogram
+{
+public:
+  static const int num_buckets = 32;
+
+  LatencyHistogram();
+
+  void record(std::uint64_t nanoseconds);
+  void merge(const LatencyHistogram& other);
+  void clear();
+  auto getCount() const -> std::uint64_t;
+  // Upper bound in nanoseconds of the bucket the given fraction (0 to 1) of
+  // samples fall under
+  auto percentile(double fraction) const -> std::uint64_t;
+
+private:
+  std::array<std::uint32_t, num_buckets> buckets;
+  std::uint64_t                          count;
+};
+
+// Bounded single producer, single consumer queue of timestamped actions. A
+// full queue is the backpressure signal, the sender has to back off.
+class InputQueue
+{
+public:
+  static const std::uint32_t capacity = 16;
+
+  InputQueue();
+
+  auto push(Action action, std::uint64_t time) -> bool;
+  auto pop(Action& action, std::uint64_t& time) -> bool;
+  // Only safe while nobody is pushing or popping
+  void clear();
+
+private:
+  std::array<std::uint64_t, capacity> times;
+  std::array<Action, capacity>        actions;
+  std::atomic<std::uint32_t>          head;  // advanced by the consumer
+  std::atomic<std::uint32_t>          tail;  // advanced by the producer
+};
+
+// Hosts many headless games in one process. Each session is an Engine plus
+// its input queue and latency histogram, all in one flat array so ticking
+// them walks memory in order. Sessions are ticked in fixed size batches on
+// the thread pool, whose workers take the next batch as they free up.
+//
+// open, close and tick belong to the server thread. send can come from any
+// thread as long as each session only has one sender at a time.
+class SessionServer
+{
+public:
+  SessionServer(ThreadPool& pool,
+                int         max_sessions,
+                int         gravity_ticks,
+                int         batch_size = 256);
+
+  // Returns the new session id, or -1 when every slot is taken
+  auto open(std::uint64_t seed) -> int;
+  void close(int id);
+  // Queues an action for the next tick. False when the session's queue is
+  // full or the session isn't open, nothing is queued then.
+  auto send(int id, Action action) -> bool;
+  // Applies queued input and gravity to every open session
+  void tick();
+
+  auto isOpen(int id) const -> bool;
+  auto getEngine(int id) const -> const Engine&;
+  auto getLatency(int id) const -> const LatencyHistogram&;
+  auto getActiveCount() const -> int;
+  auto getMaxSessions() const -> int;
+  auto getRejected() const -> std::uint64_t;
+  auto getTicks() const -> std::uint64_t;
+
+  // Monotonic clock in nanoseconds, what queued actions are stamped with
+  static auto now() -> std::uint64_t;
+
+  // Most queued actions applied to one session per tick, so a flooding
+  // client fills its own queue instead of holding up the batch
+  static const int max_inputs_per_tick = 4;
+
+private:
+  struct Session
+  {
+    Engine            engine { 0 };
+    InputQueue        inputs;
+    LatencyHistogram  latency;
+    std::int32_t      gravity_counter = 0;
+    std::atomic<bool> active { false };
+  };
+
+  void tickSession(Session& session, std::uint64_t time);
+
+  ThreadPool&                pool;
+  std::unique_ptr<Session[]> sessions;
+  std::vector<int>           free_ids;
+  int                        max_sessions;
+  int                        gravity_ticks;
+  int                        batch_size;
+  int                        active_count;
+  std::uint64_t              ticks;
+  std::atomic<std::uint64_t> rejected;
+};
+
+}  // namespace tetris
@@ -0,0 +1,175 @@
+#include "stats.hpp"
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+#ifdef TETRIS_COUNT_ALLOCATIONS
+static std::atomic<long> allocations(0);
+
+auto operator new(std::size_t size) -> void*
+{
+  allocations.fetch_add(1, std::memory_order_relaxed);
+  if (void* ptr = std::malloc(size == 0 ? 1 : size))
+  {
+    return ptr;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+
+void operator delete(void* ptr, std::size_t) noexcept { std::free(ptr); }
+#endif
+
+// Quads the batch holds before rlgl has to flush it on its own
+static const int batch_quads = 8192;
+
+FrameStats::FrameStats()
+: visible(false)
+, batch(rlLoadRenderBatch(1, batch_quads))
+, current {}
+, last {}
+, frame(0)
+, frame_allocations(0)
+, rate_start(Clock::now())
+, rate_locks(0)
+, rate_lines(0)
+, locks_per_second(0)
+, lines_per_minute(0)
+{
+  rlSetRenderBatchActive(&batch);
+}
+
+FrameStats::~FrameStats()
+{
+  // Flushes what's left and goes back to raylib's own batch
+  rlSetRenderBatchActive(nullptr);
+  rlUnloadRenderBatch(batch);
+}
+
+auto FrameStats::openCsv(const std::string& path) -> bool
+{
+  csv.open(path);
+  if (!csv)
+  {
+    return false;
+  }
+  csv << "frame,sim_ms,draw_ms,draw_calls,vertices,allocations,"
+         "cache_redraws,locks_per_second,lines_per_minute\n";
+  return true;
+}
+
+void FrameStats::beginFrame()
+{
+  current           = {};
+  frame_allocations = allocationCount();
+}
+
+void FrameStats::beginSim() { section_start = Clock::now(); }
+
+void FrameStats::endSim() { current.sim_ms += elapsedMs(); }
+
+void FrameStats::beginDraw() { section_start = Clock::now(); }
+
+void FrameStats::endDraw() { current.draw_ms += elapsedMs(); }
+
+void FrameStats::endFrame()
+{
+  current.allocations = frame_allocations < 0
+                          ? -1
+                          : allocationCount() - frame_allocations;
+  last                = current;
+  frame++;
+
+  auto   now     = Clock::now();
+  double seconds = std::chrono::duration<double>(now - rate_start).count();
+  if (seconds >= 1.0)
+  {
+    locks_per_second = rate_locks / seconds;
+    lines_per_minute = rate_lines * 60.0 / seconds;
+    rate_locks       = 0;
+    rate_lines       = 0;
+    rate_start       = now;
+  }
+
+  if (csv.is_open())
+  {
+    csv << frame << ',' << last.sim_ms << ',' << last.draw_ms << ','
+        << last.draw_calls << ',' << last.vertices << ',' << last.allocations
+        << ',' << last.cache_redraws << ',' << locks_per_second << ','
+        << lines_per_minute << '\n';
+  }
+}
+
+void FrameStats::countBatch()
+{
+  // The last draw is left open for the next call and is often still empty
+  for (int i = 0; i < batch.drawCounter; i++)
+  {
+    if (batch.draws[i].vertexCount > 0)
+    {
+      current.draw_calls++;
+      current.vertices += batch.draws[i].vertexCount;
+    }
+  }
+}
+
+void FrameStats::countCacheRedraw() { current.cache_redraws++; }
+
+void FrameStats::countLock(int lines)
+{
+  rate_locks++;
+  rate_lines += lines;
+}
+
+void FrameStats::draw(int x, int y)
+{
+  if (!visible)
+  {
+    return;
+  }
+  // Formatted into a fixed buffer so the overlay doesn't allocate itself
+  char lines[5][48];
+  std::snprintf(lines[0],
+                sizeof(lines[0]),
+                "sim %.2fms draw %.2fms",
+                last.sim_ms,
+                last.draw_ms);
+  std::snprintf(lines[1],
+                sizeof(lines[1]),
+                "draws %d verts %d",
+                last.draw_calls,
+                last.vertices);
+  std::snprintf(lines[2],
+                sizeof(lines[2]),
+                "allocs %ld redraws %d",
+                last.allocations,
+                last.cache_redraws);
+  std::snprintf(
+    lines[3], sizeof(lines[3]), "locks/s %.2f", locks_per_second);
+  std::snprintf(
+    lines[4], sizeof(lines[4]), "lines/min %.1f", lines_per_minute);
+  for (int i = 0; i < 5; i++)
+  {
+    DrawText(lines[i], x, y + i * 20, 16, RAYWHITE);
+  }
+}
+
+auto FrameStats::getLast() const -> const Frame& { return last; }
+
+auto FrameStats::allocationCount() -> long
+{
+#ifdef TETRIS_COUNT_ALLOCATIONS
+  return allocations.load(std::memory_order_relaxed);
+#else
+  return -1;
+#endif
+}
+
+auto FrameStats::elapsedMs() const -> double
+{
+  return std::chrono::duration<double, std::milli>(Clock::now()
+                                                   - section_start)
+    .count();
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include "../include/raylib-cpp.hpp"
+#include "../vendor/raylib/src/rlgl.h"
+#include <chrono>
+#include <fstream>
+#include <string>
+
+// Per frame counters for the front end: simulation and draw time, how much
+// gets drawn, heap allocations and lock/line rates. Shown in an overlay when
+// visible and written to a CSV file, one row per frame, when one is open.
+//
+// Draw calls and vertices are read out of an rlgl render batch the stats own
+// and make active, just before each flush. Allocations are only counted in
+// builds made with countAllocations=1, which replace the global operator new
+// in stats.cpp.
+class FrameStats
+{
+public:
+  struct Frame
+  {
+    double sim_ms;
+    double draw_ms;
+    // Draw calls rlgl flushed to the GPU, and the vertices in them
+    int    draw_calls;
+    int    vertices;
+    // -1 when the build doesn't count allocations
+    long   allocations;
+    int    cache_redraws;
+  };
+
+  bool visible;
+
+  // Needs the window open, its batch replaces raylib's default one
+  FrameStats();
+  ~FrameStats();
+  FrameStats(const FrameStats&)                    = delete;
+  auto operator=(const FrameStats&) -> FrameStats& = delete;
+
+  // Writes a header now and a row every frame after, false if the file
+  // can't be opened
+  auto openCsv(const std::string& path) -> bool;
+
+  void beginFrame();
+  void beginSim();
+  void endSim();
+  void beginDraw();
+  void endDraw();
+  void endFrame();
+
+  // Adds up the draws waiting in the batch, call right before anything that
+  // flushes it: EndTextureMode, EndDrawing
+  void countBatch();
+  void countCacheRedraw();
+  void countLock(int lines);
+
+  // Draws the overlay with the last finished frame's numbers
+  void draw(int x, int y);
+
+  auto getLast() const -> const Frame&;
+  // Heap allocations since the program started, -1 when not counted
+  static auto allocationCount() -> long;
+
+private:
+  using Clock = std::chrono::steady_clock;
+
+  // Big enough that a frame never fills it, so rlgl only flushes where the
+  // front end asks it to and every flush gets counted
+  rlRenderBatch     batch;
+  Frame             current;
+  Frame             last;
+  long              frame;
+  long              frame_allocations;
+  Clock::time_point section_start;
+  // Lock and line rates are worked out once a second
+  Clock::time_point rate_start;
+  int               rate_locks;
+  int               rate_lines;
+  double            locks_per_second;
+  double            lines_per_minute;
+  std::ofstream     csv;
+
+  auto elapsedMs() const -> double;
+};
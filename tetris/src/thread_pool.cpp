@@ -0,0 +1,155 @@
+#include "thread_pool.hpp"
+
+namespace tetris
+{
+
+ThreadPool::ThreadPool(int num_threads)
+: stopping(false)
+{
+  jobs.fill(nullptr);
+  if (num_threads < 1)
+  {
+    num_threads = 1;
+  }
+  for (int i = 0; i < num_threads; i++)
+  {
+    threads.emplace_back([this]() { workerLoop(); });
+  }
+}
+
+ThreadPool::~ThreadPool()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = true;
+  }
+  wake.notify_all();
+  for (auto& thread : threads)
+  {
+    thread.join();
+  }
+}
+
+auto ThreadPool::defaultThreadCount() -> int
+{
+  auto count = static_cast<int>(std::thread::hardware_concurrency());
+  return count > 0 ? count : 1;
+}
+
+auto ThreadPool::size() const -> int
+{
+  return static_cast<int>(threads.size());
+}
+
+void ThreadPool::run(Job& job)
+{
+  if (job.count <= 0)
+  {
+    return;
+  }
+  job.remaining.store(job.count, std::memory_order_relaxed);
+
+  int slot = -1;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (int i = 0; i < max_jobs && slot < 0; i++)
+    {
+      if (jobs[i] == nullptr)
+      {
+        jobs[i] = &job;
+        slot    = i;
+      }
+    }
+  }
+  if (slot < 0)
+  {
+    // Every slot taken, nothing to share it with
+    work(job);
+    return;
+  }
+  wake.notify_all();
+
+  work(job);
+  while (job.remaining.load(std::memory_order_acquire) > 0)
+  {
+    // Help out with other jobs, nested ones included, while workers finish
+    // the last indices of this one
+    Job* other = nullptr;
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      other = findJob();
+      if (other != nullptr)
+      {
+        other->users++;
+      }
+    }
+    if (other != nullptr)
+    {
+      work(*other);
+      other->users.fetch_sub(1, std::memory_order_release);
+    }
+    else
+    {
+      std::this_thread::yield();
+    }
+  }
+
+  // Once out of its slot nobody new picks the job up, then wait out anyone
+  // still holding it before it goes off the stack
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    jobs[slot] = nullptr;
+  }
+  while (job.users.load(std::memory_order_acquire) > 0)
+  {
+    std::this_thread::yield();
+  }
+}
+
+void ThreadPool::work(Job& job)
+{
+  while (true)
+  {
+    int i = job.next.fetch_add(1, std::memory_order_relaxed);
+    if (i >= job.count)
+    {
+      return;
+    }
+    job.run(job.context, i);
+    job.remaining.fetch_sub(1, std::memory_order_release);
+  }
+}
+
+auto ThreadPool::findJob() -> Job*
+{
+  for (Job* job : jobs)
+  {
+    if (job != nullptr
+        && job->next.load(std::memory_order_relaxed) < job->count)
+    {
+      return job;
+    }
+  }
+  return nullptr;
+}
+
+void ThreadPool::workerLoop()
+{
+  while (true)
+  {
+    Job* job = nullptr;
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      wake.wait(lock, [&]() { return stopping || (job = findJob()) != nullptr; });
+      if (stopping)
+      {
+        return;
+      }
+      job->users++;
+    }
+    work(*job);
+    job->users.fetch_sub(1, std::memory_order_release);
+  }
+}
+
+}  // namespace tetris
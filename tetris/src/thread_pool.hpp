@@ -0,0 +1,78 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace tetris
+{
+
+// Fixed set of worker threads running parallelFor jobs. A job is a function
+// and an index range that workers claim one index at a time from a shared
+// counter, so uneven indices still spread across every core. Jobs live on
+// the caller's stack and sit in a fixed table of slots while they run, so
+// handing out work never allocates.
+class ThreadPool
+{
+public:
+  // Jobs that can run at once, parallelFor inside parallelFor included
+  static const int max_jobs = 64;
+
+  explicit ThreadPool(int num_threads = defaultThreadCount());
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool&)                    = delete;
+  auto operator=(const ThreadPool&) -> ThreadPool& = delete;
+
+  static auto defaultThreadCount() -> int;
+
+  auto size() const -> int;
+
+  // Runs fn(i) for every i in [0, count) and returns once all are done. The
+  // calling thread works on the job too, and on other jobs while it waits.
+  template <typename Fn>
+  void parallelFor(int count, Fn&& fn)
+  {
+    using Callable = std::remove_reference_t<Fn>;
+    Job job;
+    job.run = [](const void* context, int i) {
+      (*static_cast<Callable*>(const_cast<void*>(context)))(i);
+    };
+    job.context = static_cast<const void*>(std::addressof(fn));
+    job.count   = count;
+    run(job);
+  }
+
+private:
+  struct Job
+  {
+    void (*run)(const void* context, int i);
+    const void*      context;
+    int              count;
+    // Next index to hand out, and indices not finished yet
+    std::atomic<int> next{ 0 };
+    std::atomic<int> remaining{ 0 };
+    // Threads that picked the job out of its slot and may still touch it
+    std::atomic<int> users{ 0 };
+  };
+
+  void run(Job& job);
+  // Runs indices of the job until none are left to claim
+  static void work(Job& job);
+  // A job with indices left to claim, or null. Call with mutex held.
+  auto findJob() -> Job*;
+  void workerLoop();
+
+  std::array<Job*, max_jobs> jobs;
+  std::vector<std::thread>   threads;
+  std::mutex                 mutex;
+  std::condition_variable    wake;
+  bool                       stopping;
+};
+
+}  // namespace tetris
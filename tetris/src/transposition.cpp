@@ -0,0 +1,73 @@
+#include "transposition.hpp"
+#include <bit>
+
+namespace tetris
+{
+
+TranspositionTable::TranspositionTable(int size_bits)
+: entries(std::make_unique<Entry[]>(std::size_t(1) << size_bits))
+, mask((std::uint64_t(1) << size_bits) - 1)
+{
+  clear();
+}
+
+auto TranspositionTable::key(std::uint64_t board_hash, int piece, int hold)
+  -> std::uint64_t
+{
+  std::uint64_t z = board_hash ^ (static_cast<std::uint64_t>(piece) << 56)
+                    ^ (static_cast<std::uint64_t>(hold) << 60);
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+  return z ^ (z >> 31);
+}
+
+auto TranspositionTable::probe(std::uint64_t key, double& value) -> bool
+{
+  probes.fetch_add(1, std::memory_order_relaxed);
+  auto& entry = entries[key & mask];
+  auto  data  = entry.data.load(std::memory_order_relaxed);
+  auto  check = entry.check.load(std::memory_order_relaxed);
+  if ((check ^ data) != key)
+  {
+    return false;
+  }
+  hits.fetch_add(1, std::memory_order_relaxed);
+  value = std::bit_cast<double>(data);
+  return true;
+}
+
+void TranspositionTable::store(std::uint64_t key, double value)
+{
+  stores.fetch_add(1, std::memory_order_relaxed);
+  auto& entry = entries[key & mask];
+  auto  data  = std::bit_cast<std::uint64_t>(value);
+  entry.data.store(data, std::memory_order_relaxed);
+  entry.check.store(key ^ data, std::memory_order_relaxed);
+}
+
+void TranspositionTable::clear()
+{
+  for (std::uint64_t i = 0; i <= mask; i++)
+  {
+    // An empty slot only matches the all ones key
+    entries[i].data.store(0, std::memory_order_relaxed);
+    entries[i].check.store(~std::uint64_t(0), std::memory_order_relaxed);
+  }
+  probes = 0;
+  hits   = 0;
+  stores = 0;
+}
+
+auto TranspositionTable::getStats() const -> Stats
+{
+  return { probes.load(), hits.load(), stores.load() };
+}
+
+auto TranspositionTable::hitRate() const -> double
+{
+  auto stats = getStats();
+  return stats.probes == 0 ? 0.0
+                           : static_cast<double>(stats.hits) / stats.probes;
+}
+
+}  // namespace tetris
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+namespace tetris
+{
+
+// Fixed size cache of search results shared by every search thread without
+// locks. Each slot keeps the value next to the key xor'd with it, so a slot
+// torn by two threads writing at once fails the key check instead of
+// returning the wrong value. Colliding positions simply overwrite each other.
+class TranspositionTable
+{
+public:
+  struct Stats
+  {
+    std::uint64_t probes;
+    std::uint64_t hits;
+    std::uint64_t stores;
+  };
+
+  // Holds 2^size_bits entries of 16 bytes
+  explicit TranspositionTable(int size_bits = 16);
+
+  // hold is the id of the held block, 0 when nothing is held
+  static auto key(std::uint64_t board_hash, int piece, int hold)
+    -> std::uint64_t;
+
+  auto probe(std::uint64_t key, double& value) -> bool;
+  void store(std::uint64_t key, double value);
+  void clear();
+  auto getStats() const -> Stats;
+  auto hitRate() const -> double;
+
+private:
+  struct Entry
+  {
+    std::atomic<std::uint64_t> check;
+    std::atomic<std::uint64_t> data;
+  };
+
+  std::unique_ptr<Entry[]>   entries;
+  std::uint64_t              mask;
+  std::atomic<std::uint64_t> probes;
+  std::atomic<std::uint64_t> hits;
+  std::atomic<std::uint64_t> stores;
+};
+
+}  // namespace tetris
@@ -0,0 +1,266 @@
+#include "tuner.hpp"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <fstream>
+
+namespace tetris
+{
+
+static auto toArray(const Weights& weights) -> std::array<double, 4>
+{
+  return { weights.aggregate_height,
+           weights.lines,
+           weights.holes,
+           weights.bumpiness };
+}
+
+static auto fromArray(const std::array<double, 4>& values) -> Weights
+{
+  Weights weights;
+  weights.aggregate_height = values[0];
+  weights.lines            = values[1];
+  weights.holes            = values[2];
+  weights.bumpiness        = values[3];
+  return weights;
+}
+
+// Scaled to unit length, which doesn't change what a player picks
+static auto normalize(const Weights& weights) -> Weights
+{
+  auto   values = toArray(weights);
+  double length = 0;
+  for (double value : values)
+  {
+    length += value * value;
+  }
+  length = std::sqrt(length);
+  if (length > 0)
+  {
+    for (double& value : values)
+    {
+      value /= length;
+    }
+  }
+  return fromArray(values);
+}
+
+auto saveWeights(const std::string& path, const Weights& weights) -> bool
+{
+  std::ofstream file(path);
+  file.precision(17);
+  file << "aggregate_height " << weights.aggregate_height << '\n'
+       << "lines " << weights.lines << '\n'
+       << "holes " << weights.holes << '\n'
+       << "bumpiness " << weights.bumpiness << '\n';
+  return file.good();
+}
+
+auto loadWeights(const std::string& path, Weights& weights) -> bool
+{
+  std::ifstream file(path);
+  Weights       loaded;
+  std::string   name;
+  double        value = 0;
+  int           found = 0;
+  while (file >> name >> value)
+  {
+    if (name == "aggregate_height")
+    {
+      loaded.aggregate_height = value;
+    }
+    else if (name == "lines")
+    {
+      loaded.lines = value;
+    }
+    else if (name == "holes")
+    {
+      loaded.holes = value;
+    }
+    else if (name == "bumpiness")
+    {
+      loaded.bumpiness = value;
+    }
+    else
+    {
+      return false;
+    }
+    found++;
+  }
+  if (found != 4)
+  {
+    return false;
+  }
+  weights = loaded;
+  return true;
+}
+
+auto Tuner::GameKeyHash::operator()(const GameKey& key) const -> std::size_t
+{
+  std::uint64_t hash = key.seed;
+  for (double value : toArray(key.weights))
+  {
+    // Adding zero turns -0.0 into 0.0, the two compare equal
+    hash ^= std::bit_cast<std::uint64_t>(value + 0.0);
+    hash *= 0x9e3779b97f4a7c15;
+    hash ^= hash >> 32;
+  }
+  return static_cast<std::size_t>(hash);
+}
+
+Tuner::Tuner(ThreadPool& pool, TunerOptions options)
+: pool(pool)
+, options(options)
+, rng(options.seed)
+, generation(0)
+, best {}
+, mean_fitness(0)
+, games_played(0)
+, cache_hits(0)
+{
+  this->options.population = std::max(2, options.population);
+  this->options.games      = std::max(1, options.games);
+  // The hand tuned weights go in too, so the search can only improve on them
+  population.push_back({ normalize(Weights()), 0 });
+  while (static_cast<int>(population.size()) < this->options.population)
+  {
+    population.push_back({ randomWeights(), 0 });
+  }
+  best = population.front();
+}
+
+void Tuner::step()
+{
+  if (generation > 0)
+  {
+    std::sort(population.begin(),
+              population.end(),
+              [](const Candidate& a, const Candidate& b) {
+                return a.fitness > b.fitness;
+              });
+    std::uniform_real_distribution<double> chance(0, 1);
+    std::uniform_real_distribution<double> nudge(-0.2, 0.2);
+    std::uniform_int_distribution<int>     component(0, 3);
+
+    int                    survivors = std::max(1, options.population / 4);
+    std::vector<Candidate> children;
+    while (survivors + static_cast<int>(children.size()) < options.population)
+    {
+      const Candidate& a = tournament();
+      const Candidate& b = tournament();
+      auto             x = toArray(a.weights);
+      auto             y = toArray(b.weights);
+
+      // The child leans towards the fitter parent
+      std::array<double, 4> values;
+      for (int i = 0; i < 4; i++)
+      {
+        values[i] = x[i] * (a.fitness + 1) + y[i] * (b.fitness + 1);
+      }
+      if (chance(rng) < 0.1)
+      {
+        values[component(rng)] += nudge(rng);
+      }
+      children.push_back({ normalize(fromArray(values)), 0 });
+    }
+    std::copy(children.begin(), children.end(), population.begin() + survivors);
+  }
+  scorePopulation();
+  generation++;
+}
+
+auto Tuner::getGeneration() const -> int { return generation; }
+
+auto Tuner::getBest() const -> const Weights& { return best.weights; }
+
+auto Tuner::getBestFitness() const -> double { return best.fitness; }
+
+auto Tuner::getMeanFitness() const -> double { return mean_fitness; }
+
+auto Tuner::getGamesPlayed() const -> long { return games_played; }
+
+auto Tuner::getCacheHits() const -> long { return cache_hits; }
+
+void Tuner::scorePopulation()
+{
+  jobs.clear();
+  for (int i = 0; i < options.population; i++)
+  {
+    population[i].fitness = 0;
+    for (int game = 0; game < options.games; game++)
+    {
+      GameKey key  = { population[i].weights, options.seed + game };
+      auto    item = cache.find(key);
+      if (item != cache.end())
+      {
+        population[i].fitness += item->second;
+        cache_hits++;
+      }
+      else
+      {
+        jobs.push_back({ i, key.seed });
+      }
+    }
+  }
+
+  // Each task writes only its own result slot, nothing is shared
+  results.resize(jobs.size());
+  pool.parallelFor(static_cast<int>(jobs.size()), [this](int i) {
+    thread_local GreedyPlayer player;
+
+    player.weights = population[jobs[i].candidate].weights;
+    results[i]     = playGreedyGame(jobs[i].seed, player, options.max_pieces);
+  });
+  games_played += static_cast<long>(jobs.size());
+
+  for (std::size_t i = 0; i < jobs.size(); i++)
+  {
+    Candidate& candidate = population[jobs[i].candidate];
+    cache.emplace(GameKey { candidate.weights, jobs[i].seed }, results[i]);
+    candidate.fitness += results[i];
+  }
+
+  double total = 0;
+  for (auto& candidate : population)
+  {
+    candidate.fitness /= options.games;
+    total += candidate.fitness;
+    if (candidate.fitness > best.fitness)
+    {
+      best = candidate;
+    }
+  }
+  mean_fitness = total / options.population;
+}
+
+// Best of a few candidates picked at random
+auto Tuner::tournament() -> const Candidate&
+{
+  std::uniform_int_distribution<int> pick(0, options.population - 1);
+
+  int size   = std::max(2, options.population / 10);
+  int winner = pick(rng);
+  for (int i = 1; i < size; i++)
+  {
+    int other = pick(rng);
+    if (population[other].fitness > population[winner].fitness)
+    {
+      winner = other;
+    }
+  }
+  return population[winner];
+}
+
+auto Tuner::randomWeights() -> Weights
+{
+  std::uniform_real_distribution<double> value(-1, 1);
+  std::array<double, 4>                  values;
+  for (double& item : values)
+  {
+    item = value(rng);
+  }
+  return normalize(fromArray(values));
+}
+
+}  // namespace tetris
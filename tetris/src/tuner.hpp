@@ -0,0 +1,101 @@
+#pragma once
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "ai.hpp"
+#include "thread_pool.hpp"
+
+namespace tetris
+{
+
+auto saveWeights(const std::string& path, const Weights& weights) -> bool;
+// Reads weights written by saveWeights, false unless all four are there
+auto loadWeights(const std::string& path, Weights& weights) -> bool;
+
+struct TunerOptions
+{
+  int           population = 32;
+  // Games each candidate plays, seeds seed to seed + games - 1
+  int           games      = 50;
+  int           max_pieces = 1000;
+  std::uint64_t seed       = 1;
+};
+
+// Genetic search over GreedyPlayer weights. A candidate's fitness is the
+// average rows cleared over the same set of seeded games every generation.
+// Each generation keeps the best quarter and fills the rest with children
+// of tournament winners: the parents' weights averaged by fitness, now and
+// then nudged in one direction. Only the direction of the weights matters
+// to a player, so they are kept at unit length.
+//
+// Games are played on the pool, one task per (candidate, seed) pair, and
+// every result is cached under that pair. Candidates that survive a
+// generation are never played again.
+class Tuner
+{
+public:
+  Tuner(ThreadPool& pool, TunerOptions options);
+
+  // Scores the starting population on the first call, then breeds and
+  // scores one generation per call
+  void step();
+
+  auto getGeneration() const -> int;
+  auto getBest() const -> const Weights&;
+  // Average rows cleared per game
+  auto getBestFitness() const -> double;
+  auto getMeanFitness() const -> double;
+  // Games actually played and games answered from the cache
+  auto getGamesPlayed() const -> long;
+  auto getCacheHits() const -> long;
+
+private:
+  struct Candidate
+  {
+    Weights weights;
+    double  fitness;
+  };
+
+  struct GameKey
+  {
+    Weights       weights;
+    std::uint64_t seed;
+
+    auto operator==(const GameKey&) const -> bool = default;
+  };
+
+  struct GameKeyHash
+  {
+    auto operator()(const GameKey& key) const -> std::size_t;
+  };
+
+  struct Job
+  {
+    int           candidate;
+    std::uint64_t seed;
+  };
+
+  void scorePopulation();
+  auto tournament() -> const Candidate&;
+  auto randomWeights() -> Weights;
+
+  ThreadPool&                                   pool;
+  TunerOptions                                  options;
+  std::mt19937_64                               rng;
+  std::vector<Candidate>                        population;
+  std::unordered_map<GameKey, int, GameKeyHash> cache;
+  // Reused every generation so scoring only allocates when the cache grows
+  std::vector<Job>                              jobs;
+  std::vector<int>                              results;
+  int                                           generation;
+  Candidate                                     best;
+  double                                        mean_fitness;
+  long                                          games_played;
+  long                                          cache_hits;
+};
+
+}  // namespace tetris
@@ -0,0 +1,575 @@
+// Property tests for the engine. Random action sequences are played through
+// tetris::Engine and, in lock step, through a deliberately naive reference
+// model on a plain 2D array. After every step the two have to agree on every
+// cell, the block, the score and game over, and the engine has to hold its
+// own invariants: the falling block never overlaps locked cells, clearing
+// rows keeps every other cell, and the bitboard queries match the reference.
+// Boards with 32 and 64 bit rows get random edits checked against a rescan and
+// the engine played on them, and BatchEnv's copy of the rules is played next
+// to one Engine per board.
+//
+// The same checks are a libFuzzer entry point when built with
+// -DTETRIS_FUZZER (make fuzz). Otherwise main feeds in seeded random inputs.
+//
+// Usage: engine_props [inputs=2000] [seed=1]
+
+#include "../src/batch.hpp"
+#include "../src/engine.hpp"
+#include "../src/grid.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace tetris;
+
+static bool failed = false;
+
+static void check(bool condition, const char* what)
+{
+  if (condition || failed)
+  {
+    return;
+  }
+  std::fprintf(stderr, "check failed: %s\n", what);
+  failed = true;
+#ifdef TETRIS_FUZZER
+  std::abort();
+#endif
+}
+
+using Cells = std::array<std::array<int, Grid::num_cols>, Grid::num_rows>;
+
+static auto isOutside(int row, int column) -> bool
+{
+  return row < 0 || row >= Grid::num_rows || column < 0
+         || column >= Grid::num_cols;
+}
+
+// Clears full rows the slow way, copying every row that survives to the
+// bottom of a fresh board
+static auto clearRows(Cells& cells) -> int
+{
+  Cells result = {};
+  int   target = Grid::num_rows - 1;
+  for (int row = Grid::num_rows - 1; row >= 0; row--)
+  {
+    bool full = true;
+    for (int value : cells[row])
+    {
+      full = full && value != 0;
+    }
+    if (!full)
+    {
+      result[target--] = cells[row];
+    }
+  }
+  cells = result;
+  return target + 1;
+}
+
+// The rules written out as plainly as possible, sharing only the piece
+// tables and the randomizer with the engine
+class ReferenceEngine
+{
+public:
+  Cells cells;
+  Block current;
+  Block next;
+  int   score;
+  int   lines;
+  int   spawns;
+  bool  game_over;
+
+  explicit ReferenceEngine(std::uint64_t seed)
+  : randomizer(seed)
+  {
+    current   = Block(randomizer.next());
+    next      = Block(randomizer.next());
+    cells     = {};
+    score     = 0;
+    lines     = 0;
+    spawns    = 0;
+    game_over = false;
+  }
+
+  auto fits(const Block& block) const -> bool
+  {
+    for (const auto& cell : block.getCellPosition())
+    {
+      if (isOutside(cell.row, cell.column) || cells[cell.row][cell.column])
+      {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  void step(Action action)
+  {
+    if (action == Action::Reset)
+    {
+      current   = Block(randomizer.next());
+      next      = Block(randomizer.next());
+      cells     = {};
+      score     = 0;
+      lines     = 0;
+      game_over = false;
+      spawns++;
+      return;
+    }
+    if (game_over)
+    {
+      return;
+    }
+    Block moved = current;
+    switch (action)
+    {
+      case Action::Left:
+        moved.move(0, -1);
+        if (fits(moved))
+        {
+          current = moved;
+        }
+        break;
+      case Action::Right:
+        moved.move(0, 1);
+        if (fits(moved))
+        {
+          current = moved;
+        }
+        break;
+      case Action::Down:
+        moved.move(1, 0);
+        if (fits(moved))
+        {
+          current = moved;
+          score += 1;
+        }
+        else
+        {
+          lock();
+        }
+        break;
+      case Action::Rotate:
+        moved.rotate();
+        for (const auto& kick : current.getKicks())
+        {
+          Block kicked = moved;
+          kicked.move(kick.row, kick.column);
+          if (fits(kicked))
+          {
+            current = kicked;
+            break;
+          }
+        }
+        break;
+      case Action::HardDrop:
+        while (true)
+        {
+          moved = current;
+          moved.move(1, 0);
+          if (!fits(moved))
+          {
+            break;
+          }
+          current = moved;
+          score += 1;
+        }
+        lock();
+        break;
+      case Action::Reset:
+        break;
+    }
+  }
+
+private:
+  void lock()
+  {
+    for (const auto& cell : current.getCellPosition())
+    {
+      cells[cell.row][cell.column] = current.id;
+    }
+    current   = next;
+    game_over = !fits(current);
+    spawns++;
+    next      = Block(randomizer.next());
+
+    static const int points[5] = { 0, 100, 300, 500, 0 };
+    int              cleared   = clearRows(cells);
+    lines += cleared;
+    score += points[cleared];
+  }
+
+  BagRandomizer randomizer;
+};
+
+static auto sameBlock(const Block& a, const Block& b) -> bool
+{
+  auto a_cells = a.getCellPosition();
+  auto b_cells = b.getCellPosition();
+  for (int i = 0; i < 4; i++)
+  {
+    if (a_cells[i].row != b_cells[i].row
+        || a_cells[i].column != b_cells[i].column)
+    {
+      return false;
+    }
+  }
+  return a.id == b.id;
+}
+
+// Cell by cell comparison of a grid with the reference cells, including the
+// bitboard queries, column heights and hash
+static void checkGrid(const Grid& grid, const Cells& cells)
+{
+  Grid rebuilt;
+  for (int row = -2; row < Grid::num_rows + 2; row++)
+  {
+    for (int col = -2; col < Grid::num_cols + 2; col++)
+    {
+      check(grid.isCellOutside(row, col) == isOutside(row, col),
+            "isCellOutside matches the bounds");
+      if (isOutside(row, col))
+      {
+        continue;
+      }
+      check(grid.getCell(row, col) == cells[row][col], "cell colours match");
+      check(grid.isCellEmpty(row, col) == (cells[row][col] == 0),
+            "isCellEmpty matches the cells");
+      rebuilt.setCell(row, col, cells[row][col]);
+    }
+  }
+  for (int col = 0; col < Grid::num_cols; col++)
+  {
+    int height = 0;
+    for (int row = Grid::num_rows - 1; row >= 0; row--)
+    {
+      if (cells[row][col] != 0)
+      {
+        height = Grid::num_rows - row;
+      }
+    }
+    check(grid.getColumnHeight(col) == height, "column heights match");
+  }
+  check(grid.getHash() == rebuilt.getHash(), "hash matches a fresh grid");
+}
+
+// Fills a grid from the input bytes, a byte per row with some rows forced
+// full, then clears it next to the reference
+static void checkClear(const std::uint8_t* data, std::size_t size)
+{
+  Grid  grid;
+  Cells cells = {};
+  int   count = 0;
+  for (std::size_t i = 0; i < size && i < Grid::num_rows * 2; i += 2)
+  {
+    int  row  = Grid::num_rows - 1 - static_cast<int>(i / 2);
+    bool full = (data[i] & 3) == 0;
+    for (int col = 0; col < Grid::num_cols; col++)
+    {
+      bool filled = full || (i + 1 < size && (data[i + 1] >> (col % 8)) & 1);
+      if (filled)
+      {
+        int colour = 1 + (row + col) % 7;
+        grid.setCell(row, col, colour);
+        cells[row][col] = colour;
+        count++;
+      }
+    }
+  }
+
+  int cleared = grid.clearFullRoads();
+  check(cleared == clearRows(cells), "clearFullRoads clears the full rows");
+
+  int remaining = 0;
+  for (int row = 0; row < Grid::num_rows; row++)
+  {
+    for (int col = 0; col < Grid::num_cols; col++)
+    {
+      remaining += !grid.isCellEmpty(row, col);
+    }
+  }
+  check(remaining == count - cleared * Grid::num_cols,
+        "clearing rows keeps every other cell");
+  checkGrid(grid, cells);
+}
+
+// Checks a board of any width against a rescan of its own cells: the row
+// masks against the colours, the hash against a grid filled from scratch and
+// every column height against the highest filled cell
+template <typename G>
+static void checkRescan(const G& grid)
+{
+  G rebuilt;
+  for (int row = 0; row < G::num_rows; row++)
+  {
+    for (int col = 0; col < G::num_cols; col++)
+    {
+      bool filled = grid.getCell(row, col) != 0;
+      check(((grid.rowMask(row) >> col) & 1) == filled,
+            "row masks match the cell colours");
+      rebuilt.setCell(row, col, grid.getCell(row, col));
+    }
+  }
+  check(grid.getHash() == rebuilt.getHash(), "hash matches a fresh grid");
+  for (int col = 0; col < G::num_cols; col++)
+  {
+    int height = 0;
+    for (int row = G::num_rows - 1; row >= 0; row--)
+    {
+      if (grid.getCell(row, col) != 0)
+      {
+        height = G::num_rows - row;
+      }
+    }
+    check(grid.getColumnHeight(col) == height, "column heights match");
+  }
+}
+
+// Plays the input bytes as edits to a board of any width, two bytes an edit:
+// set or clear a cell, fill a row, add garbage or clear full rows. The
+// standard board only has 16 bit rows, this covers the wider masks.
+template <typename G>
+static void checkWideGrid(const std::uint8_t* data, std::size_t size)
+{
+  G grid;
+  for (std::size_t i = 0; i + 1 < size && !failed; i += 2)
+  {
+    int row    = data[i + 1] % G::num_rows;
+    int column = data[i + 1] % G::num_cols;
+    switch (data[i] % 8)
+    {
+      case 0:
+      case 1:
+      case 2:
+        grid.setCell(row, (data[i] >> 3) % G::num_cols, 1 + data[i] % 7);
+        break;
+      case 3:
+        grid.setCell(row, (data[i] >> 3) % G::num_cols, 0);
+        break;
+      case 4:
+      case 5:
+        for (int col = 0; col < G::num_cols; col++)
+        {
+          grid.setCell(row, col, 1 + col % 7);
+        }
+        break;
+      case 6:
+        grid.addGarbage(1 + (data[i] >> 3) % 4, column, garbage_colour);
+        break;
+      case 7:
+      {
+        int full = 0;
+        for (int r = 0; r < G::num_rows; r++)
+        {
+          full += grid.rowMask(r) == G::full_row;
+        }
+        check(grid.clearFullRoads() == full,
+              "clearFullRoads clears every full row");
+        break;
+      }
+    }
+    checkRescan(grid);
+  }
+}
+
+// Plays every board of a BatchEnv next to an Engine with the same seed, the
+// same action on each. The boards have to match cell for cell, along with
+// the blocks, scores, rewards and restarts, which BatchEnv does by itself
+// and the engines are reset for.
+static void checkBatch(std::uint64_t      seed,
+                       const std::uint8_t* data,
+                       std::size_t         size)
+{
+  static const int num_boards = 8;
+
+  BatchEnv            batch(num_boards, seed);
+  std::vector<Engine> engines;
+  for (int i = 0; i < num_boards; i++)
+  {
+    engines.emplace_back(seed + i);
+  }
+
+  std::array<Action, num_boards>       actions;
+  std::array<int, num_boards>          rewards;
+  std::array<std::uint8_t, num_boards> done;
+  for (std::size_t i = 0; i + num_boards <= size && !failed; i += num_boards)
+  {
+    for (int board = 0; board < num_boards; board++)
+    {
+      std::uint8_t byte = data[i + board];
+      actions[board]    = byte == 0xff ? Action::Reset
+                                       : static_cast<Action>(byte % 5);
+    }
+    batch.step(actions.data(), rewards.data(), done.data());
+
+    for (int board = 0; board < num_boards; board++)
+    {
+      Engine& engine = engines[board];
+      int     before = engine.score;
+      engine.step(actions[board]);
+      int reward = actions[board] == Action::Reset ? 0 : engine.score - before;
+      check(rewards[board] == reward, "batch rewards match the engine");
+      check(done[board] == engine.game_over, "batch restarts on game over");
+      if (engine.game_over)
+      {
+        engine.reset();
+      }
+
+      const Grid::RowMask* rows = batch.getRows(board);
+      for (int row = 0; row < Grid::num_rows; row++)
+      {
+        check(rows[row] == engine.grid.rowMask(row),
+              "batch boards match the engine");
+      }
+      check(sameBlock(batch.getBlock(board), engine.getCurrentBlock()),
+            "batch blocks match the engine");
+      check(batch.getNextBlockId(board) == engine.getNextBlock().id,
+            "batch next blocks match the engine");
+      check(batch.getScore(board) == engine.score,
+            "batch scores match the engine");
+    }
+  }
+}
+
+template <typename E>
+static void checkNoOverlap(const E& engine)
+{
+  if (engine.game_over)
+  {
+    return;
+  }
+  for (const auto& cell : engine.getCurrentBlock().getCellPosition())
+  {
+    check(!engine.grid.isCellOutside(cell.row, cell.column),
+          "the falling block is inside the grid");
+    check(engine.grid.isCellOutside(cell.row, cell.column)
+            || engine.grid.isCellEmpty(cell.row, cell.column),
+          "the falling block doesn't overlap locked cells");
+  }
+}
+
+// Plays the input bytes as actions through the engine on a board of any width,
+// checking the falling block against the locked cells and the grid against a
+// rescan. Sideways moves repeat up to 32 times so blocks reach both edges of
+// a 64 column board.
+template <typename G>
+static void checkWideEngine(std::uint64_t      seed,
+                            const std::uint8_t* data,
+                            std::size_t         size)
+{
+  static const Action actions[8] = {
+    Action::Left,   Action::Right,    Action::Down, Action::Rotate,
+    Action::Rotate, Action::HardDrop, Action::Down, Action::Down,
+  };
+  BasicEngine<G> engine(seed);
+  for (std::size_t i = 0; i < size && !failed; i++)
+  {
+    Action action  = engine.game_over ? Action::Reset : actions[data[i] % 8];
+    int    repeats = action == Action::Left || action == Action::Right
+                       ? 1 + (data[i] >> 3)
+                       : 1;
+    for (int repeat = 0; repeat < repeats; repeat++)
+    {
+      engine.step(action);
+      checkNoOverlap(engine);
+    }
+    checkRescan(engine.grid);
+  }
+}
+
+// The first eight bytes are the seed, every byte after is an action. Resets
+// are rare on purpose so games get deep enough to clear rows.
+static void runInput(const std::uint8_t* data, std::size_t size)
+{
+  std::uint64_t seed = 0;
+  std::size_t   i    = 0;
+  for (; i < size && i < 8; i++)
+  {
+    seed = seed << 8 | data[i];
+  }
+
+  checkClear(data + i, size - i);
+  // Capped, the rescan after every edit is slow next to the engine steps
+  std::size_t edits = std::min<std::size_t>(size - i, 512);
+  checkWideGrid<BasicGrid<20, 32>>(data + i, edits);
+  checkWideGrid<BasicGrid<20, 64>>(data + i, edits);
+  checkWideEngine<BasicGrid<20, 32>>(seed, data + i, edits);
+  checkWideEngine<BasicGrid<20, 64>>(seed, data + i, edits);
+  checkBatch(seed, data + i, size - i);
+
+  static const Action actions[8] = {
+    Action::Left,   Action::Right,    Action::Down, Action::Rotate,
+    Action::Rotate, Action::HardDrop, Action::Down, Action::Down,
+  };
+  Engine          engine(seed);
+  ReferenceEngine reference(seed);
+  for (; i < size && !failed; i++)
+  {
+    Action action = data[i] == 0xff ? Action::Reset : actions[data[i] % 8];
+    if (engine.game_over)
+    {
+      action = Action::Reset;
+    }
+    engine.step(action);
+    reference.step(action);
+
+    checkNoOverlap(engine);
+    checkGrid(engine.grid, reference.cells);
+    check(sameBlock(engine.getCurrentBlock(), reference.current),
+          "current blocks match");
+    check(sameBlock(engine.getNextBlock(), reference.next),
+          "next blocks match");
+    check(engine.score == reference.score, "scores match");
+    check(engine.lines == reference.lines, "line counts match");
+    check(engine.spawns == reference.spawns, "spawn counts match");
+    check(engine.game_over == reference.game_over, "game over matches");
+  }
+}
+
+extern "C" auto LLVMFuzzerTestOneInput(const std::uint8_t* data,
+                                       std::size_t         size) -> int
+{
+  runInput(data, size);
+  return 0;
+}
+
+#ifndef TETRIS_FUZZER
+auto main(int argc, char** argv) -> int
+{
+  int  inputs = argc > 1 ? std::atoi(argv[1]) : 2000;
+  auto seed   = argc > 2 ? std::stoul(argv[2]) : 1u;
+
+  std::mt19937                       rng(seed);
+  std::uniform_int_distribution<int> byte(0, 255);
+  std::uniform_int_distribution<int> length(1, 4096);
+  std::vector<std::uint8_t>          data;
+  long                               steps = 0;
+  for (int n = 0; n < inputs && !failed; n++)
+  {
+    data.resize(length(rng));
+    for (auto& value : data)
+    {
+      value = static_cast<std::uint8_t>(byte(rng));
+    }
+    runInput(data.data(), data.size());
+    steps += static_cast<long>(data.size());
+    if (failed)
+    {
+      std::fprintf(stderr, "input %d of seed %lu failed\n", n, seed);
+    }
+  }
+  if (failed)
+  {
+    return 1;
+  }
+  std::printf("%d inputs, %ld steps, all checks passed\n", inputs, steps);
+  return 0;
+}
+#endif
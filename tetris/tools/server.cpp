@@ -0,0 +1,154 @@
+// Load test for SessionServer. Opens a number of sessions and ticks them at a
+// fixed rate while a loopback client thread stands in for the network layer,
+// pushing random actions into the sessions' queues the way a socket reader
+// would after decoding packets. Prints tick times, input latency and how
+// many sends were turned away by backpressure.
+//
+// Usage: server [sessions=10000] [seconds=5] [tick rate=60]
+
+#include "../src/session_server.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <thread>
+#include <utility>
+#include <vector>
+
+using namespace tetris;
+
+// Sends each session an action roughly every few ticks, like a player
+// mashing keys. Reset now and again so topped out boards keep playing.
+class LoopbackClient
+{
+public:
+  LoopbackClient(SessionServer& server, std::vector<int> ids)
+  : server(server)
+  , ids(std::move(ids))
+  , stopping(false)
+  , sent(0)
+  {
+    thread = std::thread([this]() { run(); });
+  }
+
+  ~LoopbackClient() { stop(); }
+
+  void stop()
+  {
+    stopping.store(true);
+    if (thread.joinable())
+    {
+      thread.join();
+    }
+  }
+
+  auto getSent() const -> long { return sent; }
+
+private:
+  void run()
+  {
+    std::mt19937                       rng(1);
+    std::uniform_int_distribution<int> action(0, 99);
+    std::bernoulli_distribution        active(0.1);
+    while (!stopping.load(std::memory_order_relaxed))
+    {
+      for (int id : ids)
+      {
+        if (!active(rng))
+        {
+          continue;
+        }
+        int roll = action(rng);
+        auto act = roll < 30 ? Action::Left
+                 : roll < 60 ? Action::Right
+                 : roll < 80 ? Action::Rotate
+                 : roll < 95 ? Action::Down
+                 : roll < 99 ? Action::HardDrop
+                             : Action::Reset;
+        if (server.send(id, act))
+        {
+          sent++;
+        }
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+  }
+
+  SessionServer&    server;
+  std::vector<int>  ids;
+  std::atomic<bool> stopping;
+  long              sent;
+  std::thread       thread;
+};
+
+auto main(int argc, char** argv) -> int
+{
+  int    num_sessions = argc > 1 ? std::atoi(argv[1]) : 10000;
+  double seconds      = argc > 2 ? std::atof(argv[2]) : 5.0;
+  double tick_rate    = argc > 3 ? std::atof(argv[3]) : 60.0;
+
+  ThreadPool    pool;
+  auto          gravity = std::max(1, static_cast<int>(tick_rate / 5));
+  SessionServer server(pool, num_sessions, gravity);
+
+  std::vector<int> ids;
+  for (int i = 0; i < num_sessions; i++)
+  {
+    ids.push_back(server.open(static_cast<std::uint64_t>(i) + 1));
+  }
+  std::printf("%d sessions, %d threads, %.0f ticks/s, %zu bytes/session\n",
+              server.getActiveCount(),
+              pool.size(),
+              tick_rate,
+              sizeof(Engine) + sizeof(InputQueue) + sizeof(LatencyHistogram));
+
+  LatencyHistogram tick_times;
+  LoopbackClient   client(server, ids);
+  auto             interval = std::chrono::duration<double>(1.0 / tick_rate);
+  auto             start    = std::chrono::steady_clock::now();
+  auto             next     = start;
+  long             late     = 0;
+  while (std::chrono::steady_clock::now() - start
+         < std::chrono::duration<double>(seconds))
+  {
+    auto begin = SessionServer::now();
+    server.tick();
+    tick_times.record(SessionServer::now() - begin);
+
+    next += std::chrono::duration_cast<std::chrono::nanoseconds>(interval);
+    if (std::chrono::steady_clock::now() > next)
+    {
+      late++;
+      next = std::chrono::steady_clock::now();
+    }
+    std::this_thread::sleep_until(next);
+  }
+  client.stop();
+
+  LatencyHistogram latency;
+  long             total_score = 0;
+  for (int id : ids)
+  {
+    latency.merge(server.getLatency(id));
+    total_score += server.getEngine(id).score;
+  }
+
+  std::printf("ticks          %llu (%ld late)\n",
+              static_cast<unsigned long long>(server.getTicks()),
+              late);
+  std::printf("tick time      p50 < %8.1f us  p99 < %8.1f us\n",
+              tick_times.percentile(0.5) / 1000.0,
+              tick_times.percentile(0.99) / 1000.0);
+  std::printf("input latency  p50 < %8.1f us  p99 < %8.1f us\n",
+              latency.percentile(0.5) / 1000.0,
+              latency.percentile(0.99) / 1000.0);
+  std::printf("inputs         %llu applied, %ld sent, %llu rejected\n",
+              static_cast<unsigned long long>(latency.getCount()),
+              client.getSent(),
+              static_cast<unsigned long long>(server.getRejected()));
+  std::printf("total score    %ld\n", total_score);
+  return 0;
+}
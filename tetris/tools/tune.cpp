@@ -0,0 +1,67 @@
+// Tunes the evaluation weights with a genetic search over seeded greedy
+// games played on every core, then saves the best weights found. The game
+// picks them up with --weights for its autoplayer.
+//
+// Usage: tune [generations=10] [population=32] [games=50] [max pieces=1000]
+//             [seed=1] [output=weights.txt]
+
+#include "../src/tuner.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+using namespace tetris;
+
+auto main(int argc, char** argv) -> int
+{
+  TunerOptions options;
+  int          generations = argc > 1 ? std::atoi(argv[1]) : 10;
+  options.population       = argc > 2 ? std::atoi(argv[2]) : 32;
+  options.games            = argc > 3 ? std::atoi(argv[3]) : 50;
+  options.max_pieces       = argc > 4 ? std::atoi(argv[4]) : 1000;
+  options.seed             = argc > 5 ? std::stoull(argv[5]) : 1ull;
+  std::string output       = argc > 6 ? argv[6] : "weights.txt";
+
+  ThreadPool pool;
+  Tuner      tuner(pool, options);
+  std::printf("%d candidates, %d games each, up to %d pieces, %d threads\n",
+              options.population,
+              options.games,
+              options.max_pieces,
+              pool.size());
+  for (int i = 0; i < generations; i++)
+  {
+    auto start  = std::chrono::steady_clock::now();
+    long played = tuner.getGamesPlayed();
+    tuner.step();
+    double seconds = std::chrono::duration<double>(
+                       std::chrono::steady_clock::now() - start)
+                       .count();
+
+    const Weights& best = tuner.getBest();
+    std::printf("generation %2d: best %.1f lines, mean %.1f, %ld games in "
+                "%.2fs, weights %.3f %.3f %.3f %.3f\n",
+                tuner.getGeneration(),
+                tuner.getBestFitness(),
+                tuner.getMeanFitness(),
+                tuner.getGamesPlayed() - played,
+                seconds,
+                best.aggregate_height,
+                best.lines,
+                best.holes,
+                best.bumpiness);
+  }
+  std::printf("%ld games played, %ld answered from the cache\n",
+              tuner.getGamesPlayed(),
+              tuner.getCacheHits());
+
+  if (!saveWeights(output, tuner.getBest()))
+  {
+    std::fprintf(stderr, "can't write %s\n", output.c_str());
+    return 1;
+  }
+  std::printf("saved to %s\n", output.c_str());
+  return 0;
+}
@@ -0,0 +1,137 @@
+// Plays a two player versus match between two RollbackPeers over a loopback
+// transport with latency, each peer driven by the AI. Afterwards both peers
+// and a plain lock step run of every input that was sent have to agree on
+// the final state, and the time spent advancing (rollbacks included) is
+// printed.
+//
+// Usage: versus [frames=3000] [latency=4] [input delay=2] [seed=1]
+
+#include "../src/ai.hpp"
+#include "../src/match.hpp"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+using namespace tetris;
+
+// Frames between AI inputs, roughly how fast a person taps keys
+static const int action_interval = 4;
+static const int gravity_frames  = 30;
+
+auto main(int argc, char** argv) -> int
+{
+  int  frames      = argc > 1 ? std::atoi(argv[1]) : 3000;
+  int  latency     = argc > 2 ? std::atoi(argv[2]) : 4;
+  int  input_delay = argc > 3 ? std::atoi(argv[3]) : 2;
+  auto seed        = argc > 4 ? std::stoull(argv[4]) : 1ull;
+
+  ThreadPool                pool;
+  LoopbackTransport         transport(2, latency);
+  std::vector<RollbackPeer> peers;
+  std::array<Player, 2>     players = { Player(pool), Player(pool) };
+  for (int i = 0; i < 2; i++)
+  {
+    peers.emplace_back(i, 2, seed, gravity_frames, input_delay);
+  }
+
+  // Every input that went out, by frame, for the lock step check
+  std::vector<std::array<Input, 2>> sent(frames + input_delay + 1);
+  long   stalls     = 0;
+  long   advances   = 0;
+  double total_us   = 0;
+  double slowest_us = 0;
+  for (int frame = 0; frame < frames; frame++)
+  {
+    transport.tick();
+    for (int i = 0; i < 2; i++)
+    {
+      InputMessage message;
+      while (transport.receive(i, message))
+      {
+        peers[i].addRemoteInput(message);
+      }
+
+      // Plans again for every input, gravity keeps moving the block under a
+      // plan made earlier
+      const Engine& engine = peers[i].getMatch().getEngine(i);
+      Input         input  = no_input;
+      if (frame % action_interval == 0 && !engine.game_over)
+      {
+        auto plan = players[i].plan(engine);
+        if (!plan.empty())
+        {
+          input = toInput(plan.front());
+        }
+      }
+
+      auto start = std::chrono::steady_clock::now();
+      bool ok    = peers[i].advance(input, message);
+      auto us    = std::chrono::duration<double, std::micro>(
+                  std::chrono::steady_clock::now() - start)
+                  .count();
+      if (!ok)
+      {
+        stalls++;
+        continue;
+      }
+      advances++;
+      total_us += us;
+      slowest_us = std::max(slowest_us, us);
+      transport.send(i, message);
+      sent[message.frame][i] = input;
+    }
+  }
+
+  // Let everything in flight arrive and fix up the last predictions
+  for (int i = 0; i <= latency; i++)
+  {
+    transport.tick();
+  }
+  bool agree = true;
+  for (int i = 0; i < 2; i++)
+  {
+    InputMessage message;
+    while (transport.receive(i, message))
+    {
+      peers[i].addRemoteInput(message);
+    }
+    peers[i].rollback();
+
+    const Match& match = peers[i].getMatch();
+    Match        reference(2, seed, gravity_frames);
+    while (reference.getFrame() < match.getFrame())
+    {
+      reference.step(sent[reference.getFrame()].data());
+    }
+    bool same = reference.getChecksum() == match.getChecksum();
+    agree     = agree && same;
+    std::printf("peer %d: frame %u, %ld rollbacks, %ld frames resimulated, "
+                "%s the lock step run\n",
+                i,
+                match.getFrame(),
+                peers[i].getRollbacks(),
+                peers[i].getResimulatedFrames(),
+                same ? "matches" : "DIFFERS FROM");
+  }
+
+  const Match& match = peers[0].getMatch();
+  for (int i = 0; i < 2; i++)
+  {
+    const Engine& engine = match.getEngine(i);
+    std::printf("player %d: score %d, %d lines%s\n",
+                i,
+                engine.score,
+                engine.lines,
+                engine.game_over ? ", topped out" : "");
+  }
+  std::printf("advance: %.2f us average, %.2f us slowest, %ld stalls\n",
+              total_us / std::max(1l, advances),
+              slowest_us,
+              stalls);
+  return agree ? 0 : 1;
+}